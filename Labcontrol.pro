@@ -1,41 +1,91 @@
-QT       += core gui network widgets
+QT       += concurrent core gui network widgets
 
 TARGET = labcontrol
 TEMPLATE = app
 
 
-SOURCES += src/localzleafstarter.cpp \
+SOURCES += src/commandoutputwindow.cpp \
+    src/helprequestspanel.cpp \
+    src/instrumentedapplication.cpp \
+    src/labmapview.cpp \
+    src/localzleafstarter.cpp \
     src/main.cpp \
     src/mainwindow.cpp \
     src/manualprintingsetup.cpp \
+    src/thumbnailwall.cpp \
+    src/Lib/bootscheduler.cpp \
     src/Lib/client.cpp \
+    src/Lib/clientaction.cpp \
+    src/Lib/clientinventory.cpp \
     src/Lib/clienthelpnotificationserver.cpp \
     src/Lib/clientpinger.cpp \
+    src/Lib/clientselection.cpp \
+    src/Lib/clientsgridmodel.cpp \
+    src/Lib/commandexecution.cpp \
+    src/Lib/instrumentation.cpp \
     src/Lib/lablib.cpp \
+    src/Lib/latexformatcache.cpp \
+    src/Lib/latexreceiptstemplate.cpp \
     src/Lib/netstatagent.cpp \
+    src/Lib/paymentfile.cpp \
+    src/Lib/pdfreceiptsrenderer.cpp \
     src/Lib/receipts_handler.cpp \
+    src/Lib/receiptsbatch.cpp \
+    src/Lib/receiptsjournal.cpp \
     src/Lib/receiptsprinter.cpp \
+    src/Lib/receiptsscheduler.cpp \
     src/Lib/session.cpp \
+    src/Lib/sessionstarter.cpp \
     src/Lib/sessionsmodel.cpp \
     src/Lib/settings.cpp \
+    src/Lib/settingsreloader.cpp \
+    src/Lib/startupprofiler.cpp \
+    src/Lib/thumbnailpoller.cpp \
+    src/Lib/zleafstarttracer.cpp \
     src/Lib/ztree.cpp
 
-HEADERS  += src/localzleafstarter.h \
+HEADERS  += src/commandoutputwindow.h \
+    src/helprequestspanel.h \
+    src/instrumentedapplication.h \
+    src/labmapview.h \
+    src/localzleafstarter.h \
     src/mainwindow.h \
     src/manualprintingsetup.h \
+    src/thumbnailwall.h \
+    src/Lib/bootscheduler.h \
     src/Lib/client.h \
+    src/Lib/clientaction.h \
+    src/Lib/clientinventory.h \
     src/Lib/clienthelpnotificationserver.h \
     src/Lib/clientpinger.h \
+    src/Lib/clientselection.h \
+    src/Lib/clientsgridmodel.h \
+    src/Lib/commandexecution.h \
+    src/Lib/instrumentation.h \
     src/Lib/lablib.h \
+    src/Lib/latexformatcache.h \
+    src/Lib/latexreceiptstemplate.h \
     src/Lib/netstatagent.h \
+    src/Lib/paymentfile.h \
+    src/Lib/pdfreceiptsrenderer.h \
     src/Lib/receipts_handler.h \
+    src/Lib/receiptsbatch.h \
+    src/Lib/receiptsjournal.h \
     src/Lib/receiptsprinter.h \
+    src/Lib/receiptsscheduler.h \
     src/Lib/session.h \
+    src/Lib/sessionstarter.h \
     src/Lib/sessionsmodel.h \
     src/Lib/settings.h \
+    src/Lib/settingsreloader.h \
+    src/Lib/startupprofiler.h \
+    src/Lib/thumbnailpoller.h \
+    src/Lib/zleafstarttracer.h \
     src/Lib/ztree.h
 
-FORMS    += src/localzleafstarter.ui \
+FORMS    += src/commandoutputwindow.ui \
+    src/helprequestspanel.ui \
+    src/localzleafstarter.ui \
     src/mainwindow.ui \
     src/manualprintingsetup.ui
 
@@ -47,6 +97,7 @@ OTHER_FILES += \
     PROGRAMMING \
     README \
     data/example_header.tex \
+    data/example_receipt.json \
     data/Labcontrol.conf \
     data/scripts/kill_zLeaf_labcontrol2.sh \
     data/scripts/start_zLeaf_labcontrol2.sh \
@@ -0,0 +1,197 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <memory>
+
+#include <QDebug>
+
+#include "bootscheduler.h"
+#include "settings.h"
+
+extern std::unique_ptr<lc::Settings> settings;
+
+namespace {
+//! Boots taking longer than this (in milliseconds) are not learned from
+const qint64 maximumBootDuration = 600000;
+} // namespace
+
+/*!
+ * \brief Construct a new boot scheduler
+ *
+ * \param[in] argParent The instance's parent QObject
+ */
+lc::BootScheduler::BootScheduler(QObject *const argParent)
+    : QObject{argParent}, history{"Labcontrol", "BootHistory", this} {
+  clock.start();
+  waveTimer.setSingleShot(true);
+  connect(&waveTimer, &QTimer::timeout, this, &BootScheduler::StartNextWave);
+}
+
+/*!
+ * \brief Queue the given clients for booting and start the first wave
+ *
+ * Clients which are already queued are ignored. If a boot is already in
+ * progress, the clients will be booted in its later waves.
+ *
+ * \param[in] argClients The clients which shall be booted
+ */
+void lc::BootScheduler::Boot(const QVector<Client *> &argClients) {
+  const bool bootInProgress = IsBooting() || waveTimer.isActive();
+  for (auto *const client : argClients) {
+    if (!queue.contains(client)) {
+      queue.append(client);
+    }
+  }
+  // Boot the clients known to be slow first, so that they are ready in time
+  std::stable_sort(queue.begin(), queue.end(),
+                   [this](const Client *const argA, const Client *const argB) {
+                     return GetLearnedBootDuration(argA) >
+                            GetLearnedBootDuration(argB);
+                   });
+  if (!bootInProgress) {
+    StartNextWave();
+  }
+}
+
+/*!
+ * \brief Return the learned time the client needs until it responds
+ *
+ * \param[in] argClient The client whose boot duration shall be returned
+ *
+ * \return The learned boot duration in milliseconds or 0 if none is known
+ */
+int lc::BootScheduler::GetLearnedBootDuration(
+    const Client *const argClient) const {
+  return history.value("boot_durations/" + argClient->name, 0).toInt();
+}
+
+/*!
+ * \brief Return the timeout of the wave which was powered on most recently
+ *
+ * If the boot durations of all the wave's clients are known, the timeout is
+ * shortened to a margin above the slowest of them.
+ *
+ * \return The timeout in milliseconds
+ */
+int lc::BootScheduler::GetWaveTimeout() const {
+  const int configuredTimeout = settings->bootWaveTimeout * 1000;
+  int slowestBoot = 0;
+  for (const auto *const client : currentWave) {
+    const int learnedDuration = GetLearnedBootDuration(client);
+    if (learnedDuration == 0) {
+      return configuredTimeout;
+    }
+    slowestBoot = qMax(slowestBoot, learnedDuration);
+  }
+  return qMin(configuredTimeout, slowestBoot + slowestBoot / 4 + 5000);
+}
+
+/*!
+ * \brief Learn the boot duration of clients which started responding and start
+ * the next wave if the current one completed
+ *
+ * \param[in] argState The client's new state
+ */
+void lc::BootScheduler::GotClientStateChanged(const Client::State argState) {
+  if (argState < Client::State::RESPONDING) {
+    return;
+  }
+  Client *const client = qobject_cast<Client *>(sender());
+  if (!bootStarts.contains(client)) {
+    return;
+  }
+  RecordBootDuration(client, clock.elapsed() - bootStarts.take(client));
+  disconnect(client, &Client::StateChanged, this,
+             &BootScheduler::GotClientStateChanged);
+
+  if (!waveTimer.isActive()) {
+    return;
+  }
+  for (const auto *const waveClient : currentWave) {
+    if (waveClient->GetClientState() < Client::State::RESPONDING) {
+      return;
+    }
+  }
+  waveTimer.stop();
+  StartNextWave();
+}
+
+/*!
+ * \brief Blend a measured boot duration into the client's learned one
+ *
+ * \param[in] argClient The client which booted
+ * \param[in] argDuration The measured boot duration in milliseconds
+ */
+void lc::BootScheduler::RecordBootDuration(const Client *const argClient,
+                                           const qint64 argDuration) {
+  if (argDuration > maximumBootDuration) {
+    return;
+  }
+  const int learnedDuration = GetLearnedBootDuration(argClient);
+  // Exponential moving average, to adapt slowly to changed boot durations
+  const int blendedDuration =
+      learnedDuration
+          ? static_cast<int>((3 * learnedDuration + argDuration) / 4)
+          : static_cast<int>(argDuration);
+  history.setValue("boot_durations/" + argClient->name, blendedDuration);
+  qDebug() << argClient->name << "responded" << argDuration
+           << "ms after being powered on, learned boot duration is now"
+           << blendedDuration << "ms";
+}
+
+/*!
+ * \brief Power on the next wave of queued clients
+ */
+void lc::BootScheduler::StartNextWave() {
+  currentWave.clear();
+  if (queue.isEmpty()) {
+    emit Finished();
+    return;
+  }
+
+  const int waveSize =
+      settings->bootWaveSize > 0 ? settings->bootWaveSize : queue.size();
+  while (!queue.isEmpty() && currentWave.size() < waveSize) {
+    currentWave.append(queue.takeFirst());
+  }
+  bool waveResponds = true;
+  for (auto *const client : currentWave) {
+    // Clients which respond already are not booted and complete at once
+    if (client->GetClientState() >= Client::State::RESPONDING) {
+      qDebug() << client->name << "responds already and is not powered on";
+      continue;
+    }
+    waveResponds = false;
+    bootStarts.insert(client, clock.elapsed());
+    connect(client, &Client::StateChanged, this,
+            &BootScheduler::GotClientStateChanged, Qt::UniqueConnection);
+    client->Boot();
+  }
+  qDebug() << "Powered on a wave of" << currentWave.size() << "client(s),"
+           << queue.size() << "client(s) remain queued";
+  emit WaveStarted(currentWave.size(), queue.size());
+
+  if (queue.isEmpty()) {
+    currentWave.clear();
+    emit Finished();
+    return;
+  }
+  waveTimer.start(waveResponds ? 0 : GetWaveTimeout());
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOOTSCHEDULER_H
+#define BOOTSCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QSettings>
+#include <QTimer>
+#include <QVector>
+
+#include "client.h"
+
+namespace lc {
+
+/*!
+ * \brief Boots clients in waves to avoid overloading DHCP, PXE and NFS servers
+ *
+ * Clients are powered on in waves of a configurable size. The next wave is
+ * started as soon as all clients of the previous one respond or the wave's
+ * timeout expires. The time every client needs until it responds is learned
+ * and persisted. It is used to boot slow clients first and to shorten the
+ * waves' timeouts to what the clients of a wave usually need.
+ */
+class BootScheduler : public QObject {
+  Q_OBJECT
+
+public:
+  explicit BootScheduler(QObject *argParent = nullptr);
+
+  void Boot(const QVector<Client *> &argClients);
+  int GetLearnedBootDuration(const Client *argClient) const;
+  bool IsBooting() const { return !queue.isEmpty(); }
+
+signals:
+  /*!
+   * \brief Emitted if all queued clients were powered on
+   */
+  void Finished();
+  /*!
+   * \brief Emitted whenever a new wave of clients is powered on
+   *
+   * \param argWaveSize The number of clients in the wave
+   * \param argRemaining The number of clients still waiting for a later wave
+   */
+  void WaveStarted(int argWaveSize, int argRemaining);
+
+private slots:
+  void GotClientStateChanged(Client::State argState);
+  void StartNextWave();
+
+private:
+  int GetWaveTimeout() const;
+  void RecordBootDuration(const Client *argClient, qint64 argDuration);
+
+  //! The time stamps at which the clients still booting were powered on
+  QHash<const Client *, qint64> bootStarts;
+  //! Provides monotonic time stamps for the boot duration measurements
+  QElapsedTimer clock;
+  //! The clients of the wave which was powered on most recently
+  QVector<Client *> currentWave;
+  //! Persists the learned boot durations of all clients outside of
+  //! 'Labcontrol.conf', whose modifications trigger reloads of the settings
+  QSettings history;
+  //! The clients waiting to be powered on in a later wave
+  QList<Client *> queue;
+  //! Starts the next wave if the current one takes too long
+  QTimer waveTimer;
+};
+
+} // namespace lc
+
+#endif // BOOTSCHEDULER_H
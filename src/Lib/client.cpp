@@ -25,6 +25,7 @@
 #include <QRegularExpression>
 
 #include "client.h"
+#include "clientaction.h"
 #include "clientpinger.h"
 #include "lablib.h"
 #include "settings.h"
@@ -34,23 +35,11 @@ extern std::unique_ptr<lc::Lablib> lablib;
 
 lc::Client::Client(const QString &argIP, const QString &argMAC,
                    const QString &argName, unsigned short int argXPosition,
-                   unsigned short int argYPosition, const QString &argPingCmd)
+                   unsigned short int argYPosition, const QString &argRoom,
+                   const QString &argPingCmd)
     : ip{argIP}, mac{argMAC}, name{argName}, xPosition{argXPosition},
-      yPosition{argYPosition}, protectedCycles{0} {
-  if (!argPingCmd.isEmpty()) {
-    pinger = new ClientPinger{ip, argPingCmd};
-    pinger->moveToThread(&pingerThread);
-    connect(&pingerThread, &QThread::finished, pinger, &QObject::deleteLater);
-    connect(this, &Client::PingWanted, pinger, &ClientPinger::doPing);
-    connect(pinger, &ClientPinger::ClientStateChanged, this,
-            &Client::GotStatusChanged);
-    pingerThread.start();
-
-    pingTimer = new QTimer{this};
-    connect(pingTimer, &QTimer::timeout, this, &Client::RequestAPing);
-    pingTimer->start(3000);
-  }
-
+      yPosition{argYPosition}, room{argRoom}, protectedCycles{0},
+      pingCmd{argPingCmd} {
   qDebug() << "Created client" << name << "with MAC" << mac << "and IP" << ip
            << "at position"
            << QString{QString::number(xPosition) + "x" +
@@ -101,7 +90,10 @@ void lc::Client::Boot() {
   // Output message via the debug messages tab
   qDebug() << settings->wakeonlanCmd << arguments.join(" ");
 
-  pingTimer->start(3000);
+  // The pinger is missing until the deferred checks verified its command
+  if (pingTimer) {
+    pingTimer->start(3000);
+  }
 
   protectedCycles = 7;
   GotStatusChanged(State::BOOTING);
@@ -116,9 +108,29 @@ void lc::Client::GotStatusChanged(State argState) {
       argState != State::NOT_RESPONDING) {
     return;
   }
+  const bool stateChanged = state != argState;
   state = argState;
   qDebug() << name
            << "status changed to:" << static_cast<unsigned short int>(argState);
+  if (!stateChanged) {
+    return;
+  }
+  emit StateChanged(state);
+
+  // A client which went down lost its running 'wineserver'
+  if (state != State::RESPONDING && state != State::ZLEAF_RUNNING) {
+    winePrepared = false;
+  } else if (state == State::RESPONDING &&
+             settings->prepareClientsAutomatically) {
+    PrepareWine();
+  }
+}
+
+void lc::Client::GotWinePrepared(const bool argSuccess) {
+  winePreparationRunning = false;
+  winePrepared = argSuccess;
+  qDebug() << "Wine preparation on" << name
+           << (argSuccess ? "succeeded" : "failed");
 }
 
 void lc::Client::KillZLeaf() {
@@ -129,17 +141,12 @@ void lc::Client::KillZLeaf() {
             << "-q"
             << "zleaf.exe";
 
-  // Start the process
-  QProcess killZLeafProcess;
-  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-  killZLeafProcess.setProcessEnvironment(env);
-  killZLeafProcess.startDetached(settings->sshCmd, arguments);
-
-  // Output message via the debug messages tab
-  qDebug() << settings->sshCmd << arguments.join(" ");
+  RunSSHAction(arguments);
 
   // Restart the ping_timer, because it is stopped when a zLeaf is started
-  pingTimer->start(3000);
+  if (pingTimer) {
+    pingTimer->start(3000);
+  }
 }
 
 void lc::Client::OpenFilesystem(const QString *const argUserToBeUsed) {
@@ -158,7 +165,7 @@ void lc::Client::OpenFilesystem(const QString *const argUserToBeUsed) {
 
 void lc::Client::OpenTerminal(const QString &argCommand,
                               const bool &argOpenAsRoot) {
-  if (!settings->termEmulCmd.isEmpty()) {
+  if (settings->IsPathAvailable(settings->termEmulCmd)) {
     if (state < State::RESPONDING) {
       return;
     }
@@ -188,6 +195,30 @@ void lc::Client::OpenTerminal(const QString &argCommand,
   }
 }
 
+void lc::Client::PrepareWine() {
+  if (winePrepared || winePreparationRunning ||
+      !settings->IsPathAvailable(settings->sshCmd) ||
+      !settings->IsPathAvailable(settings->wineCmd) ||
+      !settings->IsPathAvailable(settings->wineserverCmd)) {
+    return;
+  }
+
+  // 'wineserver -p' stays alive persistently and 'wine cmd /c exit' loads the
+  // prefix (and its services) into it. 'ssh' waits for both, so that its exit
+  // code tells if they succeeded. Their output is discarded, since the
+  // lingering processes would otherwise keep the connection open.
+  QStringList arguments;
+  arguments << "-i" << settings->pkeyPathUser
+            << QString{settings->userNameOnClients + "@" + ip}
+            << QString{settings->wineserverCmd +
+                       " -p > /dev/null 2>&1 && DISPLAY=:0.0 " +
+                       settings->wineCmd + " cmd /c exit > /dev/null 2>&1"};
+
+  winePreparationRunning = true;
+  ClientAction *const action = RunSSHAction(arguments, false);
+  connect(action, &ClientAction::Finished, this, &Client::GotWinePrepared);
+}
+
 void lc::Client::RequestAPing() {
   if (protectedCycles > 0) {
     --protectedCycles;
@@ -195,14 +226,39 @@ void lc::Client::RequestAPing() {
   emit PingWanted();
 }
 
+lc::ClientAction *lc::Client::RunSSHAction(const QStringList &argArguments,
+                                           const bool argDetach) {
+  QStringList arguments{"-o", "ConnectTimeout=5"};
+  // '-f' lets 'ssh' return as soon as the connection was established, so that
+  // its exit code tells if the client could be reached
+  if (argDetach) {
+    arguments.prepend("-f");
+  }
+  arguments << argArguments;
+
+  ClientAction *const action =
+      new ClientAction{this, settings->sshCmd, arguments,
+                       ClientAction::GetDefaultRetryPolicy()};
+  // The backgrounded 'ssh' keeps running after the action was deleted
+  if (argDetach) {
+    action->DiscardOutput();
+  }
+  action->Start();
+  return action;
+}
+
 void lc::Client::SetStateToZLEAF_RUNNING(QString argClientIP) {
   if (argClientIP != ip) {
     return;
   }
   if (state != State::ZLEAF_RUNNING) {
-    pingTimer->stop();
+    if (pingTimer) {
+      pingTimer->stop();
+    }
     // Inform the ClientPinger instance, that zLeaf is now running
-    pinger->setStateToZLEAF_RUNNING();
+    if (pinger) {
+      pinger->setStateToZLEAF_RUNNING();
+    }
     this->GotStatusChanged(State::ZLEAF_RUNNING);
     qDebug() << "Client" << name << "got 'ZLEAF_RUNNING' signal.";
   }
@@ -234,6 +290,34 @@ void lc::Client::ShowDesktopFullControl() {
   qDebug() << settings->vncViewer << arguments.join(" ");
 }
 
+void lc::Client::StartPinging() {
+  if (pingerThread.isRunning()) {
+    return;
+  }
+  if (!pinger) {
+    if (!settings->IsPathAvailable(pingCmd)) {
+      return;
+    }
+    pinger = new ClientPinger{ip, pingCmd};
+    pinger->moveToThread(&pingerThread);
+    connect(&pingerThread, &QThread::finished, pinger, &QObject::deleteLater);
+    connect(this, &Client::PingWanted, pinger, &ClientPinger::doPing);
+    connect(pinger, &ClientPinger::ClientStateChanged, this,
+            &Client::GotStatusChanged);
+
+    pingTimer = new QTimer{this};
+    connect(pingTimer, &QTimer::timeout, this, &Client::RequestAPing);
+  }
+  pingerThread.start();
+  pingTimer->start(3000);
+}
+
+void lc::Client::StopPinging() {
+  if (pingTimer) {
+    pingTimer->stop();
+  }
+}
+
 void lc::Client::Shutdown() {
   if (state == State::NOT_RESPONDING || state == State::BOOTING ||
       state == State::SHUTTING_DOWN) {
@@ -255,54 +339,54 @@ void lc::Client::Shutdown() {
 
   // This additional 'ping_timer' start is needed for the case that the clients
   // are shut down without prior closing of zLeaves
-  pingTimer->start(3000);
+  if (pingTimer) {
+    pingTimer->start(3000);
+  }
 
   protectedCycles = 3;
   GotStatusChanged(State::SHUTTING_DOWN);
 }
 
-void lc::Client::StartZLeaf(const QString *argFakeName, QString cmd) {
-  if (state < State::RESPONDING || zLeafVersion.isEmpty() ||
+bool lc::Client::StartZLeaf(const QString *argFakeName, QString cmd,
+                            const bool argRestartRunning) {
+  // Booting clients are accepted, the start will be deferred until they respond
+  if ((state < State::RESPONDING && state != State::BOOTING) ||
+      zLeafVersion.isEmpty() ||
       GetSessionPort() < 7000) {
-    return;
+    return false;
   }
 
-  // Create a QMessageBox for user interaction if there is already a zLeaf
-  // running
-  std::unique_ptr<QMessageBox> messageBoxRunningZLeafFound;
-  if (state == State::ZLEAF_RUNNING) {
-    messageBoxRunningZLeafFound.reset(new QMessageBox{
-        QMessageBox::Warning, "Running zLeaf found",
-        QString{"There is already a zLeaf running on " + name + "."},
-        QMessageBox::No | QMessageBox::Yes});
-    messageBoxRunningZLeafFound->setInformativeText(
-        "Do you want to start a zLeaf on client " + name + " nonetheless?");
-    messageBoxRunningZLeafFound->setDefaultButton(QMessageBox::No);
-    messageBoxRunningZLeafFound->exec();
+  // The caller decides once for all clients if running z-Leaves are restarted
+  if (state == State::ZLEAF_RUNNING && !argRestartRunning) {
+    qDebug() << "Not starting another z-Leaf on" << name
+             << "since one is already running";
+    return false;
   }
 
-  if ((messageBoxRunningZLeafFound.get() != nullptr &&
-       messageBoxRunningZLeafFound->clickedButton() ==
-           messageBoxRunningZLeafFound->button(QMessageBox::Yes)) ||
-      state != State::ZLEAF_RUNNING) {
-    QStringList arguments;
-    if (argFakeName == nullptr) {
-      arguments << "-i" << settings->pkeyPathUser
-                << QString{settings->userNameOnClients + "@" + ip} << cmd;
-    } else {
-      arguments << "-i" << settings->pkeyPathUser
-                << QString{settings->userNameOnClients + "@" + ip} << cmd
-                << "/name" << *argFakeName;
-    }
+  // The z-Leaf is put into the background on the client, so that 'ssh'
+  // returns. The echoed markers allow tracing the start's phases.
+  QStringList arguments;
+  arguments << "-i" << settings->pkeyPathUser
+            << QString{settings->userNameOnClients + "@" + ip}
+            << "echo lc_ssh_connected;" << cmd;
+  if (argFakeName != nullptr) {
+    arguments << "/name" << *argFakeName;
+  }
+  arguments << "> /dev/null 2>&1 & echo lc_process_started";
 
-    // Start the process
-    QProcess startZLeafProcess;
-    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-    startZLeafProcess.setProcessEnvironment(env);
-    startZLeafProcess.startDetached(settings->sshCmd, arguments);
+  emit ZLeafStartPhaseReached(ZLeafStartPhase::COMMAND_ISSUED);
+  ClientAction *const action = RunSSHAction(arguments, false);
+  connect(action, &ClientAction::StandardOutputRead, this,
+          &Client::GotZLeafStartOutput);
+  return true;
+}
 
-    // Output message via the debug messages tab
-    qDebug() << settings->sshCmd << arguments.join(" ");
+void lc::Client::GotZLeafStartOutput(const QByteArray &argOutput) {
+  if (argOutput.contains("lc_ssh_connected")) {
+    emit ZLeafStartPhaseReached(ZLeafStartPhase::SSH_CONNECTED);
+  }
+  if (argOutput.contains("lc_process_started")) {
+    emit ZLeafStartPhaseReached(ZLeafStartPhase::PROCESS_STARTED);
   }
 }
 
@@ -338,14 +422,7 @@ void lc::Client::StartClientBrowser(const QString *const argURL,
               << "> /dev/null 2>&1 &disown";
   }
 
-  // Start the process
-  QProcess startClientBrowserProcess;
-  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-  startClientBrowserProcess.setProcessEnvironment(env);
-  startClientBrowserProcess.startDetached(settings->sshCmd, arguments);
-
-  // Output message via the debug messages tab
-  qDebug() << settings->sshCmd << arguments.join(" ");
+  RunSSHAction(arguments);
 }
 
 void lc::Client::StopClientBrowser() {
@@ -359,14 +436,7 @@ void lc::Client::StopClientBrowser() {
             << "& sleep 1 && rm -R /home/ewfuser/.mozilla/firefox/*"
             << "& killall" << settings->clientChromiumCmd;
 
-  // Start the process
-  QProcess startClientBrowserProcess;
-  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-  startClientBrowserProcess.setProcessEnvironment(env);
-  startClientBrowserProcess.startDetached(settings->sshCmd, arguments);
-
-  // Output message via the debug messages tab
-  qDebug() << settings->sshCmd << arguments.join(" ");
+  RunSSHAction(arguments);
 }
 
 void lc::Client::ControlRMB(bool enable) {
@@ -386,12 +456,5 @@ void lc::Client::ControlRMB(bool enable) {
                  "Mouse' 1 2 0 4 5 6 7 8 9 10 11 12 > /dev/null 2>&1 &disown;";
   }
 
-  // Start the process
-  QProcess startClientBrowserProcess;
-  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-  startClientBrowserProcess.setProcessEnvironment(env);
-  startClientBrowserProcess.startDetached(settings->sshCmd, arguments);
-
-  // Output message via the debug messages tab
-  qDebug() << settings->sshCmd << arguments.join(" ");
+  RunSSHAction(arguments);
 }
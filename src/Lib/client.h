@@ -30,6 +30,7 @@
 
 namespace lc {
 
+class ClientAction;
 class ClientPinger;
 
 //! Class which represents the clients in the lab
@@ -45,6 +46,15 @@ public slots:
   void SetStateToZLEAF_RUNNING(QString argClientIP);
 
 public:
+  //! The phases a z-Leaf start passes on the client before it connects
+  enum class ZLeafStartPhase : unsigned short int {
+    //! The start command was issued
+    COMMAND_ISSUED,
+    //! The 'ssh' connection to the client was established
+    SSH_CONNECTED,
+    //! The z-Leaf process was spawned on the client
+    PROCESS_STARTED
+  };
   //! Opens a terminal for the client
   enum class State : unsigned short int {
     //! The client is booting but not yet responding
@@ -67,8 +77,11 @@ public:
   const QString ip;
   const QString mac;
   const QString name;
-  const unsigned short int xPosition = 1;
-  const unsigned short int yPosition = 1;
+  //! The client's location may change if the settings are reloaded
+  unsigned short int xPosition = 1;
+  unsigned short int yPosition = 1;
+  //! The room the client is located in (empty if the lab has only one)
+  QString room;
 
   /*!
    * \brief Client's constructor
@@ -77,10 +90,11 @@ public:
    * \param argName       The hostname of the represented client
    * \param argXPosition  The client's x coordinate in the lab's grid
    * \param argYPosition  The client's y coordinate in the lab's grid
+   * \param argRoom       The room the client is located in
    */
   Client(const QString &argIP, const QString &argMAC, const QString &argName,
          unsigned short int argXPosition, unsigned short int argYPosition,
-         const QString &argPingCmd);
+         const QString &argRoom, const QString &argPingCmd);
   //! Client's destructor
   ~Client();
   //! Beams the chosen file to the client's 'media4ztree' directory
@@ -109,6 +123,17 @@ public:
   */
   State GetClientState() const { return state; }
   int GetSessionPort() const { return sessionPort; }
+  /*!
+   * \brief Returns if actions can currently be issued on the client
+   *
+   * Clients are considered reachable as long as they are not pinged. This is
+   * the case if no usable ping command is configured, but also until the
+   * deferred checks verified the configured one. Actions issued meanwhile are
+   * not held back and rely on their retries instead.
+   */
+  bool IsReachable() const {
+    return !pinger || state >= State::RESPONDING;
+  }
   /*!
    * \brief Kills all processes 'zleaf.exe' on the client
    */
@@ -125,6 +150,13 @@ public:
    * session as root (true) or as normal user (false)
    */
   void OpenTerminal(const QString &argCommand, const bool &argOpenAsRoot);
+  /*!
+   * \brief Prepares the client for fast z-Leaf starts
+   *
+   * A persistent 'wineserver' is started and the wine prefix gets loaded, so
+   * that subsequently started z-Leaves do not have to initialize wine anymore.
+   */
+  void PrepareWine();
   void SetSessionPort(int argSP) { sessionPort = argSP; }
   void SetzLeafVersion(const QString &argzLeafV) { zLeafVersion = argzLeafV; }
   //! Shows the desktop of the given client
@@ -134,13 +166,29 @@ public:
    * \brief Shuts down the client
    */
   void Shutdown();
+  /*!
+   * \brief Starts the regular pings determining the client's state
+   *
+   * This is deferred until the deferred checks found the 'ping' command, since
+   * clients without a pinger are always considered reachable.
+   */
+  void StartPinging();
+  /*!
+   * \brief Stops the regular pings, e.g. if the client was removed from the
+   * settings
+   */
+  void StopPinging();
 
   /*!
    * \brief Starts a zLeaf instance on the client
    * @param argFakeName The name the zLeaf instance shall have (if not the
    * default, which is the hostname of the client)
+   * @param argRestartRunning If an already running zLeaf shall not prevent the
+   * start of another one
+   * \return True, if the start was issued; false, if the client was skipped
    */
-  void StartZLeaf(const QString *argFakeName = nullptr, QString cmd = "");
+  bool StartZLeaf(const QString *argFakeName = nullptr, QString cmd = "",
+                  bool argRestartRunning = false);
 
   /*!
    * \brief Opens a browser window on the client
@@ -162,22 +210,49 @@ public:
 
 private:
   const QString &GetzLeafVersion() const { return zLeafVersion; }
+  /*!
+   * \brief Runs 'ssh' with the given arguments, retrying on transient failures
+   * \param argArguments The arguments passed to 'ssh'
+   * \param argDetach Let 'ssh' go to the background after connecting, so
+   * that long running commands do not block the action
+   * \return The started action
+   */
+  ClientAction *RunSSHAction(const QStringList &argArguments,
+                             bool argDetach = true);
 
   unsigned short int protectedCycles;
+  //! The command pinging the client, the pinger is created on first use
+  const QString pingCmd;
   ClientPinger *pinger = nullptr;
   QThread pingerThread;
   State state = State::UNINITIALIZED;
   QTimer *pingTimer = nullptr; //! QTimer used to trigger pings by pinger's
                                //! ClientPinger instance
   int sessionPort = 0;
+  //! Set while the wine preparation is running on the client
+  bool winePreparationRunning = false;
+  //! Set if a persistent 'wineserver' was started on the client
+  bool winePrepared = false;
   QString zLeafVersion;
 
 private slots:
   void GotStatusChanged(State argState);
+  void GotWinePrepared(bool argSuccess);
+  void GotZLeafStartOutput(const QByteArray &argOutput);
   void RequestAPing();
 
 signals:
   void PingWanted();
+  /*!
+   * \brief Emitted if the client's state changed
+   * \param argState The client's new state
+   */
+  void StateChanged(State argState);
+  /*!
+   * \brief Emitted if a z-Leaf start reached the next phase
+   * \param argPhase The reached phase
+   */
+  void ZLeafStartPhaseReached(ZLeafStartPhase argPhase);
 };
 
 } // namespace lc
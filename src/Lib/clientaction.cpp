@@ -0,0 +1,223 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+
+#include <QDebug>
+
+#include "clientaction.h"
+#include "settings.h"
+
+extern std::unique_ptr<lc::Settings> settings;
+
+namespace {
+//! The exit code 'ssh' returns if the connection itself failed
+const int sshConnectionErrorCode = 255;
+} // namespace
+
+/*!
+ * \brief Create a new action which will be issued on a client
+ *
+ * \param[in] argClient The client the action shall be issued on (also
+ * becoming the action's parent)
+ * \param[in] argProgram The program which shall be run
+ * \param[in] argArguments The arguments passed to the program
+ * \param[in] argPolicy The policy governing retries of the action
+ */
+lc::ClientAction::ClientAction(Client *const argClient,
+                               const QString &argProgram,
+                               const QStringList &argArguments,
+                               const RetryPolicy &argPolicy)
+    : QObject{argClient}, arguments{argArguments}, client{argClient},
+      currentDelay{argPolicy.initialDelay}, policy(argPolicy),
+      process{new QProcess{this}}, program{argProgram} {
+  process->setProcessEnvironment(QProcessEnvironment::systemEnvironment());
+  connect(process,
+          static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(
+              &QProcess::finished),
+          this, &ClientAction::GotProcessFinished);
+  connect(process, &QProcess::errorOccurred, this,
+          &ClientAction::GotProcessError);
+  connect(process, &QProcess::readyReadStandardOutput, this,
+          &ClientAction::GotProcessOutput);
+  connect(client, &Client::StateChanged, this,
+          &ClientAction::GotClientStateChanged);
+
+  deadlineTimer.setSingleShot(true);
+  connect(&deadlineTimer, &QTimer::timeout, this,
+          &ClientAction::GotDeadlineExpired);
+  retryTimer.setSingleShot(true);
+  connect(&retryTimer, &QTimer::timeout, this, &ClientAction::Attempt);
+}
+
+/*!
+ * \brief Send the output of the action's program to the null device
+ *
+ * This is needed for programs which outlive the action, like 'ssh -f', since
+ * writing to the closed pipes of the deleted action would kill them.
+ */
+void lc::ClientAction::DiscardOutput() {
+  process->setStandardOutputFile(QProcess::nullDevice());
+  process->setStandardErrorFile(QProcess::nullDevice());
+}
+
+/*!
+ * \brief Return the retry policy configured for client actions
+ *
+ * \return The retry policy to be used for client actions by default
+ */
+lc::ClientAction::RetryPolicy lc::ClientAction::GetDefaultRetryPolicy() {
+  RetryPolicy policy;
+  policy.initialDelay = 1000;
+  policy.backoffFactor = 2.0;
+  policy.maximumDelay = 16000;
+  policy.deadline = settings->clientActionRetryTimeout * 1000;
+  return policy;
+}
+
+/*!
+ * \brief Start the action by making the first attempt as soon as possible
+ */
+void lc::ClientAction::Start() {
+  sinceStart.start();
+  deadlineTimer.start(policy.deadline);
+  Attempt();
+}
+
+/*!
+ * \brief Run the action's process if the client is reachable or defer it
+ */
+void lc::ClientAction::Attempt() {
+  if (finished) {
+    return;
+  }
+  if (!client->IsReachable()) {
+    if (!waitingForClient) {
+      qDebug() << "Deferring action on" << client->name
+               << "until the client is reachable";
+    }
+    waitingForClient = true;
+    return;
+  }
+
+  waitingForClient = false;
+  ++attempts;
+  process->start(program, arguments);
+  qDebug() << program << arguments.join(" ") << "( attempt" << attempts
+           << "on" << client->name << ")";
+}
+
+/*!
+ * \brief Finish the action and schedule the instance for deletion
+ *
+ * \param[in] argSuccess 'true' if the action succeeded, 'false' otherwise
+ */
+void lc::ClientAction::Finish(const bool argSuccess) {
+  if (finished) {
+    return;
+  }
+  finished = true;
+  deadlineTimer.stop();
+  retryTimer.stop();
+  if (!argSuccess) {
+    qWarning() << "Giving up action on" << client->name << "after" << attempts
+               << "attempt(s) and" << sinceStart.elapsed() << "ms";
+  }
+  emit Finished(argSuccess);
+  deleteLater();
+}
+
+/*!
+ * \brief Make a deferred attempt if the client became reachable again
+ *
+ * \param[in] argState The client's new state
+ */
+void lc::ClientAction::GotClientStateChanged(const Client::State argState) {
+  Q_UNUSED(argState);
+  if (waitingForClient && client->IsReachable()) {
+    Attempt();
+  }
+}
+
+/*!
+ * \brief Give up the action if no attempt is currently running
+ *
+ * A running attempt may still succeed, but will not be retried on failure.
+ */
+void lc::ClientAction::GotDeadlineExpired() {
+  if (process->state() == QProcess::NotRunning) {
+    Finish(false);
+  }
+}
+
+/*!
+ * \brief Give up the action if its program could not be started at all
+ *
+ * \param[in] argError The error which occurred
+ */
+void lc::ClientAction::GotProcessError(const QProcess::ProcessError argError) {
+  if (argError == QProcess::FailedToStart) {
+    qWarning() << "Could not start" << program << "for action on"
+               << client->name;
+    Finish(false);
+  }
+}
+
+/*!
+ * \brief Evaluate the outcome of an attempt and retry it if it failed
+ * transiently
+ *
+ * \param[in] argExitCode The exit code of the attempt's process
+ * \param[in] argExitStatus The exit status of the attempt's process
+ */
+void lc::ClientAction::GotProcessFinished(
+    const int argExitCode, const QProcess::ExitStatus argExitStatus) {
+  if (argExitStatus == QProcess::NormalExit &&
+      argExitCode != sshConnectionErrorCode) {
+    // The client was reached, so retrying would not change the outcome
+    Finish(argExitCode == 0);
+    return;
+  }
+
+  qDebug() << "Action on" << client->name << "failed with exit code"
+           << argExitCode;
+  ScheduleRetry();
+}
+
+/*!
+ * \brief Forward the output the attempt's process wrote
+ */
+void lc::ClientAction::GotProcessOutput() {
+  emit StandardOutputRead(process->readAllStandardOutput());
+}
+
+/*!
+ * \brief Schedule the next attempt after the current backoff delay
+ */
+void lc::ClientAction::ScheduleRetry() {
+  const qint64 remaining = policy.deadline - sinceStart.elapsed();
+  if (remaining <= 0) {
+    Finish(false);
+    return;
+  }
+
+  retryTimer.start(static_cast<int>(qMin<qint64>(currentDelay, remaining)));
+  currentDelay = qMin(static_cast<int>(currentDelay * policy.backoffFactor),
+                      policy.maximumDelay);
+}
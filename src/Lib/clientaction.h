@@ -0,0 +1,117 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLIENTACTION_H
+#define CLIENTACTION_H
+
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QTimer>
+
+#include "client.h"
+
+namespace lc {
+
+/*!
+ * \brief An action issued on a client which is retried on transient failures
+ *
+ * The action's process is started as soon as the owning client is reachable.
+ * If it fails in a way which looks transient (e.g. 'ssh' could not connect,
+ * because the client's sshd is still starting), it is retried with an
+ * exponentially growing delay until it succeeds or the deadline passes.
+ * Retries are deferred until the client responds to pings again.
+ */
+class ClientAction : public QObject {
+  Q_OBJECT
+
+public:
+  //! Describes how often and how fast a failed action will be retried
+  struct RetryPolicy {
+    //! The delay before the first retry in milliseconds
+    int initialDelay;
+    //! The factor the delay is multiplied with after every failed attempt
+    double backoffFactor;
+    //! The upper bound of the delay between two attempts in milliseconds
+    int maximumDelay;
+    //! The time after which no further attempts will be made in milliseconds
+    int deadline;
+  };
+
+  ClientAction(Client *argClient, const QString &argProgram,
+               const QStringList &argArguments, const RetryPolicy &argPolicy);
+
+  void DiscardOutput();
+  static RetryPolicy GetDefaultRetryPolicy();
+  void Start();
+
+signals:
+  /*!
+   * \brief Emitted once the action succeeded or was given up
+   *
+   * \param argSuccess 'true' if the action succeeded, 'false' otherwise
+   */
+  void Finished(bool argSuccess);
+  /*!
+   * \brief Emitted if the action's process wrote to its standard output
+   *
+   * \param argOutput The output which was read
+   */
+  void StandardOutputRead(const QByteArray &argOutput);
+
+private slots:
+  void Attempt();
+  void GotClientStateChanged(Client::State argState);
+  void GotDeadlineExpired();
+  void GotProcessError(QProcess::ProcessError argError);
+  void GotProcessFinished(int argExitCode, QProcess::ExitStatus argExitStatus);
+  void GotProcessOutput();
+
+private:
+  void Finish(bool argSuccess);
+  void ScheduleRetry();
+
+  //! The number of attempts made so far
+  int attempts = 0;
+  //! The arguments passed to the action's program
+  const QStringList arguments;
+  //! The client the action is issued on
+  Client *const client = nullptr;
+  //! The delay which will be waited before the next retry
+  int currentDelay = 0;
+  //! Gives up the action if it did not succeed until the deadline
+  QTimer deadlineTimer;
+  //! Set as soon as the action succeeded or was given up
+  bool finished = false;
+  //! The retry policy applied to the action
+  const RetryPolicy policy;
+  //! The process running the current attempt
+  QProcess *const process = nullptr;
+  //! The program executing the action
+  const QString program;
+  //! Triggers the next attempt after the backoff delay
+  QTimer retryTimer;
+  //! Measures the time passed since the action was started
+  QElapsedTimer sinceStart;
+  //! Set if an attempt is deferred until the client becomes reachable
+  bool waitingForClient = false;
+};
+
+} // namespace lc
+
+#endif // CLIENTACTION_H
@@ -20,6 +20,7 @@
 #include "clienthelpnotificationserver.h"
 #include "settings.h"
 
+#include <QDebug>
 #include <QNetworkConfigurationManager>
 #include <QNetworkSession>
 #include <QTcpServer>
@@ -60,9 +61,6 @@ lc::ClientHelpNotificationServer::ClientHelpNotificationServer(
   } else {
     OpenSession();
   }
-
-  connect(helpMessageServer, &QTcpServer::newConnection, this,
-          &ClientHelpNotificationServer::SendReply);
 }
 
 /*!
@@ -101,8 +99,13 @@ void lc::ClientHelpNotificationServer::OpenSession() {
     messageBox.exec();
     return;
   }
+  connect(helpMessageServer, &QTcpServer::newConnection, this,
+          &ClientHelpNotificationServer::SendReply);
 }
 
+/*!
+ * \brief Acknowledge all pending help requests and announce them
+ */
 void lc::ClientHelpNotificationServer::SendReply() {
   QByteArray block;
   QDataStream out{&block, QIODevice::WriteOnly};
@@ -113,28 +116,16 @@ void lc::ClientHelpNotificationServer::SendReply() {
   out << static_cast<quint16>(static_cast<unsigned int>(block.size()) -
                               sizeof(quint16));
 
-  const auto clientConnection = helpMessageServer->nextPendingConnection();
-  const auto peerAddress = clientConnection->peerAddress().toString();
-  QString peerName;
-  if (settings->clIPsToClMap.contains(peerAddress)) {
-    peerName = settings->clIPsToClMap[peerAddress]->name;
-  }
+  while (helpMessageServer->hasPendingConnections()) {
+    const auto clientConnection = helpMessageServer->nextPendingConnection();
+    const auto peerAddress = clientConnection->peerAddress().toString();
 
-  connect(clientConnection, &QTcpSocket::disconnected, clientConnection,
-          &QTcpSocket::deleteLater);
-  clientConnection->write(block);
-  clientConnection->disconnectFromHost();
+    connect(clientConnection, &QTcpSocket::disconnected, clientConnection,
+            &QTcpSocket::deleteLater);
+    clientConnection->write(block);
+    clientConnection->disconnectFromHost();
 
-  if (peerName.isEmpty()) {
-    QMessageBox requestReceivedBox{
-        QMessageBox::Information, tr("Unknown client asked for help."),
-        tr("An unknown client with IP '%1' asked for help.").arg(peerAddress),
-        QMessageBox::Ok};
-    requestReceivedBox.exec();
-  } else {
-    QMessageBox requestReceivedBox{
-        QMessageBox::Information, tr("'%1' asked for help.").arg(peerName),
-        tr("'%1' asked for help.").arg(peerName), QMessageBox::Ok};
-    requestReceivedBox.exec();
+    qDebug() << "Received help request from" << peerAddress;
+    emit HelpRequested(peerAddress, settings->GetClientByIP(peerAddress));
   }
 }
@@ -27,9 +27,14 @@ class QTcpServer;
 
 namespace lc {
 
+class Client;
+
 /*!
  * \brief A server listing for connections from clients which will be
  * interpreted as help requests
+ *
+ * Every request is answered immediately and announced via 'HelpRequested',
+ * so that it can be queued without blocking the event loop.
  */
 class ClientHelpNotificationServer : public QObject {
   Q_OBJECT
@@ -37,6 +42,15 @@ class ClientHelpNotificationServer : public QObject {
 public:
   explicit ClientHelpNotificationServer(QObject *argParent = nullptr);
 
+signals:
+  /*!
+   * \brief Emitted for every help request received from a client
+   *
+   * \param argPeerAddress The IP address the request was sent from
+   * \param argClient The requesting client or 'nullptr' if it is unknown
+   */
+  void HelpRequested(const QString &argPeerAddress, lc::Client *argClient);
+
 private:
   QTcpServer *helpMessageServer = nullptr;
   const QString hostAddress;
@@ -0,0 +1,302 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "clientinventory.h"
+
+namespace {
+/*!
+ * \brief Read a pipe-separated list of client attributes from the settings
+ *
+ * \param[in] argSettings The settings to read the list from
+ * \param[in] argVariableName The name of the list's variable
+ *
+ * \return The list's entries
+ */
+QStringList ReadClientList(const QSettings &argSettings,
+                           const QString &argVariableName) {
+  const QStringList list =
+      argSettings.value(argVariableName)
+          .toString()
+          .split('|', QString::SkipEmptyParts, Qt::CaseSensitive);
+  qDebug() << argVariableName << ":" << list.join(" / ");
+  return list;
+}
+} // namespace
+
+/*!
+ * \brief Parse the inventory from a roster file
+ *
+ * Files ending in '.json' are expected to contain an array of objects with
+ * the keys 'ip', 'mac', 'name', 'xpos', 'ypos' and the optional key 'room'.
+ * All other files are parsed as CSV files whose first line names the columns
+ * using the same keys. Fields must not contain commas.
+ *
+ * \param[in] argPath The path of the roster file
+ *
+ * \return The parsed inventory (empty if the file could not be read)
+ */
+lc::ClientInventory lc::ClientInventory::FromRoster(const QString &argPath) {
+  QFile rosterFile{argPath};
+  if (!rosterFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    qWarning() << "The client roster" << argPath
+               << "could not be opened. No clients will be available for"
+                  " interaction.";
+    return ClientInventory{};
+  }
+  const QByteArray content = rosterFile.readAll();
+  qDebug() << "Reading the client roster" << argPath;
+  if (argPath.endsWith(".json", Qt::CaseInsensitive)) {
+    return FromJSONRoster(content);
+  }
+  return FromCSVRoster(content);
+}
+
+/*!
+ * \brief Parse the inventory from the pipe-separated lists in the settings
+ *
+ * \param[in] argSettings The settings containing the lists
+ *
+ * \return The parsed inventory (empty if the lists' lengths do not match)
+ */
+lc::ClientInventory
+lc::ClientInventory::FromSettings(const QSettings &argSettings) {
+  // Get the client quantity to check the value lists for clients creation for
+  // correct length
+  int clientQuantity = 0;
+  if (!argSettings.contains("client_quantity")) {
+    qWarning()
+        << "'client_quantity' was not set. The client quantity will be guessed"
+           " by the amount of client IPs set in 'client_ips'.";
+    clientQuantity = argSettings.value("client_ips", "")
+                         .toString()
+                         .split('|', QString::SkipEmptyParts, Qt::CaseSensitive)
+                         .length();
+  } else {
+    bool ok = true;
+    clientQuantity = argSettings.value("client_quantity").toInt(&ok);
+    if (!ok) {
+      qWarning() << "The variable 'client_quantity' was not convertible to int";
+    }
+  }
+  qDebug() << "'clientQuantity':" << clientQuantity;
+
+  const QStringList clientIPs = ReadClientList(argSettings, "client_ips");
+  const QStringList clientMACs = ReadClientList(argSettings, "client_macs");
+  const QStringList clientNames = ReadClientList(argSettings, "client_names");
+  const QStringList clientXPositions =
+      ReadClientList(argSettings, "client_xpos");
+  const QStringList clientYPositions =
+      ReadClientList(argSettings, "client_ypos");
+  if (clientIPs.length() != clientQuantity ||
+      clientMACs.length() != clientQuantity ||
+      clientNames.length() != clientQuantity ||
+      clientXPositions.length() != clientQuantity ||
+      clientYPositions.length() != clientQuantity) {
+    qWarning() << "The quantity of client ips, macs, names or positions does"
+                  " not match the client quantity. Client creation will fail."
+                  " No clients will be available for interaction.";
+    return ClientInventory{};
+  }
+
+  // The rooms are optional, since most labs consist of a single one
+  QStringList clientRooms = ReadClientList(argSettings, "client_rooms");
+  if (!clientRooms.isEmpty() && clientRooms.length() != clientQuantity) {
+    qWarning() << "The quantity of client rooms does not match the client"
+                  " quantity. All clients will be shown in a single room.";
+    clientRooms.clear();
+  }
+
+  ClientInventory inventory;
+  inventory.Reserve(clientQuantity);
+  for (int i = 0; i < clientQuantity; ++i) {
+    inventory.Append(clientIPs[i], clientMACs[i], clientNames[i],
+                     clientXPositions[i].toUShort(),
+                     clientYPositions[i].toUShort(),
+                     clientRooms.isEmpty() ? QString{} : clientRooms[i]);
+  }
+  return inventory;
+}
+
+/*!
+ * \brief Return the index of the client with the given MAC
+ *
+ * \param[in] argMAC The MAC to look up (case-insensitive)
+ *
+ * \return The client's index in the inventory (-1 if not contained)
+ */
+int lc::ClientInventory::IndexOfMAC(const QString &argMAC) const {
+  return macIndex.value(argMAC.toLower(), -1);
+}
+
+/*!
+ * \brief Append a client to the inventory and index it
+ *
+ * Clients whose IP or name is already contained are rejected.
+ *
+ * \param[in] argIP The client's IP
+ * \param[in] argMAC The client's MAC
+ * \param[in] argName The client's name
+ * \param[in] argXPosition The client's column in its room's grid
+ * \param[in] argYPosition The client's row in its room's grid
+ * \param[in] argRoom The client's room (empty if not set)
+ *
+ * \return 'true' if the client was appended, 'false' otherwise
+ */
+bool lc::ClientInventory::Append(const QString &argIP, const QString &argMAC,
+                                 const QString &argName,
+                                 const quint16 argXPosition,
+                                 const quint16 argYPosition,
+                                 const QString &argRoom) {
+  if (argIP.isEmpty() || argName.isEmpty()) {
+    qWarning() << "Skipping a client without IP or name";
+    return false;
+  }
+  if (ipIndex.contains(argIP) || nameIndex.contains(argName)) {
+    qWarning() << "Skipping client" << argName << "with IP" << argIP
+               << "since its IP or name is already used by another client";
+    return false;
+  }
+
+  const int index = ips.size();
+  ips.append(argIP);
+  macs.append(argMAC);
+  names.append(argName);
+  rooms.append(argRoom);
+  xPositions.append(argXPosition);
+  yPositions.append(argYPosition);
+
+  ipIndex.insert(argIP, index);
+  nameIndex.insert(argName, index);
+  // Placeholder MACs may be shared, so only the first client is indexed
+  if (!macIndex.contains(argMAC.toLower())) {
+    macIndex.insert(argMAC.toLower(), index);
+  }
+  return true;
+}
+
+/*!
+ * \brief Parse the inventory from the content of a CSV roster
+ *
+ * \param[in] argContent The roster's content
+ *
+ * \return The parsed inventory (empty if the header is invalid)
+ */
+lc::ClientInventory
+lc::ClientInventory::FromCSVRoster(const QByteArray &argContent) {
+  const QStringList lines = QString::fromUtf8(argContent).split(
+      '\n', QString::SkipEmptyParts, Qt::CaseSensitive);
+  if (lines.isEmpty()) {
+    qWarning() << "The client roster is empty";
+    return ClientInventory{};
+  }
+
+  QStringList header = lines.first().split(',');
+  for (auto &column : header) {
+    column = column.trimmed().toLower();
+  }
+  const int ipColumn = header.indexOf("ip");
+  const int macColumn = header.indexOf("mac");
+  const int nameColumn = header.indexOf("name");
+  const int xColumn = header.indexOf("xpos");
+  const int yColumn = header.indexOf("ypos");
+  const int roomColumn = header.indexOf("room");
+  if (ipColumn < 0 || macColumn < 0 || nameColumn < 0 || xColumn < 0 ||
+      yColumn < 0) {
+    qWarning() << "The client roster's header misses one of the columns 'ip',"
+                  " 'mac', 'name', 'xpos' and 'ypos'";
+    return ClientInventory{};
+  }
+
+  ClientInventory inventory;
+  inventory.Reserve(lines.size() - 1);
+  for (int i = 1; i < lines.size(); ++i) {
+    const QString line = lines.at(i).trimmed();
+    if (line.isEmpty() || line.startsWith('#')) {
+      continue;
+    }
+    QStringList fields = line.split(',');
+    for (auto &field : fields) {
+      field = field.trimmed();
+    }
+    if (fields.size() < header.size()) {
+      qWarning() << "Skipping line" << i + 1
+                 << "of the client roster since it has too few fields";
+      continue;
+    }
+    inventory.Append(fields.at(ipColumn), fields.at(macColumn),
+                     fields.at(nameColumn), fields.at(xColumn).toUShort(),
+                     fields.at(yColumn).toUShort(),
+                     roomColumn < 0 ? QString{} : fields.at(roomColumn));
+  }
+  return inventory;
+}
+
+/*!
+ * \brief Parse the inventory from the content of a JSON roster
+ *
+ * \param[in] argContent The roster's content
+ *
+ * \return The parsed inventory (empty if the content is invalid)
+ */
+lc::ClientInventory
+lc::ClientInventory::FromJSONRoster(const QByteArray &argContent) {
+  QJsonParseError error;
+  const QJsonDocument document = QJsonDocument::fromJson(argContent, &error);
+  if (!document.isArray()) {
+    qWarning() << "The client roster is no JSON array:" << error.errorString();
+    return ClientInventory{};
+  }
+
+  const QJsonArray entries = document.array();
+  ClientInventory inventory;
+  inventory.Reserve(entries.size());
+  for (const auto &entry : entries) {
+    const QJsonObject client = entry.toObject();
+    inventory.Append(client.value("ip").toString(),
+                     client.value("mac").toString(),
+                     client.value("name").toString(),
+                     static_cast<quint16>(client.value("xpos").toInt()),
+                     static_cast<quint16>(client.value("ypos").toInt()),
+                     client.value("room").toString());
+  }
+  return inventory;
+}
+
+/*!
+ * \brief Reserve space for the given number of clients in all arrays
+ *
+ * \param[in] argSize The expected number of clients
+ */
+void lc::ClientInventory::Reserve(const int argSize) {
+  ips.reserve(argSize);
+  macs.reserve(argSize);
+  names.reserve(argSize);
+  rooms.reserve(argSize);
+  xPositions.reserve(argSize);
+  yPositions.reserve(argSize);
+  ipIndex.reserve(argSize);
+  macIndex.reserve(argSize);
+  nameIndex.reserve(argSize);
+}
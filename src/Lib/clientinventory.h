@@ -0,0 +1,90 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLIENTINVENTORY_H
+#define CLIENTINVENTORY_H
+
+#include <QHash>
+#include <QSettings>
+#include <QString>
+#include <QVector>
+
+namespace lc {
+
+/*!
+ * \brief The immutable inventory of all clients in the lab
+ *
+ * The inventory is parsed once, either from a roster file (CSV or JSON) or
+ * from the pipe-separated lists in the settings. Every attribute is stored in
+ * its own contiguous array, indexed by the client's position in the
+ * inventory. Hash indexes allow constant time lookups by IP, MAC and name,
+ * e.g. for network events.
+ */
+class ClientInventory {
+public:
+  ClientInventory() = default;
+
+  static ClientInventory FromRoster(const QString &argPath);
+  static ClientInventory FromSettings(const QSettings &argSettings);
+
+  int GetSize() const { return ips.size(); }
+  const QString &GetIP(int argIndex) const { return ips.at(argIndex); }
+  const QString &GetMAC(int argIndex) const { return macs.at(argIndex); }
+  const QString &GetName(int argIndex) const { return names.at(argIndex); }
+  const QString &GetRoom(int argIndex) const { return rooms.at(argIndex); }
+  quint16 GetXPosition(int argIndex) const { return xPositions.at(argIndex); }
+  quint16 GetYPosition(int argIndex) const { return yPositions.at(argIndex); }
+  int IndexOfIP(const QString &argIP) const { return ipIndex.value(argIP, -1); }
+  int IndexOfMAC(const QString &argMAC) const;
+  int IndexOfName(const QString &argName) const {
+    return nameIndex.value(argName, -1);
+  }
+
+private:
+  bool Append(const QString &argIP, const QString &argMAC,
+              const QString &argName, quint16 argXPosition,
+              quint16 argYPosition, const QString &argRoom);
+  static ClientInventory FromCSVRoster(const QByteArray &argContent);
+  static ClientInventory FromJSONRoster(const QByteArray &argContent);
+  void Reserve(int argSize);
+
+  //! The IP of every client
+  QVector<QString> ips;
+  //! The MAC of every client
+  QVector<QString> macs;
+  //! The name of every client
+  QVector<QString> names;
+  //! The room of every client (empty if not set)
+  QVector<QString> rooms;
+  //! The column of every client in its room's grid
+  QVector<quint16> xPositions;
+  //! The row of every client in its room's grid
+  QVector<quint16> yPositions;
+
+  //! The clients' indices by IP
+  QHash<QString, int> ipIndex;
+  //! The clients' indices by lower-case MAC
+  QHash<QString, int> macIndex;
+  //! The clients' indices by name
+  QHash<QString, int> nameIndex;
+};
+
+} // namespace lc
+
+#endif // CLIENTINVENTORY_H
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "clientselection.h"
+
+/*!
+ * \brief Construct a new selection tracker for the given grid
+ *
+ * \param[in] argModel The grid model whose clients can be selected
+ * \param[in] argSelectionModel The selection model which shall be mirrored
+ * \param[in] argParent The instance's parent QObject
+ */
+lc::ClientSelection::ClientSelection(ClientsGridModel *const argModel,
+                                     QItemSelectionModel *const argSelectionModel,
+                                     QObject *const argParent)
+    : QObject{argParent}, model{argModel},
+      selectedCells{argModel->rowCount() * argModel->columnCount()} {
+  connect(argSelectionModel, &QItemSelectionModel::selectionChanged, this,
+          &ClientSelection::GotSelectionChanged);
+  connect(argModel, &ClientsGridModel::dataChanged, this,
+          &ClientSelection::GotDataChanged);
+  connect(argModel, &ClientsGridModel::modelReset, this,
+          &ClientSelection::GotModelReset);
+  Apply(argSelectionModel->selection(), true);
+}
+
+/*!
+ * \brief Set or clear the bits of all client cells within the selection
+ *
+ * \param[in] argSelection The cells whose bits shall be changed
+ * \param[in] argSelect 'true' to set the bits, 'false' to clear them
+ */
+void lc::ClientSelection::Apply(const QItemSelection &argSelection,
+                                const bool argSelect) {
+  const int columns = model->columnCount();
+  for (const auto &range : argSelection) {
+    for (int row = range.top(); row <= range.bottom(); ++row) {
+      for (int column = range.left(); column <= range.right(); ++column) {
+        const int cellIndex = row * columns + column;
+        if (selectedCells.testBit(cellIndex) == argSelect ||
+            !model->GetClient(model->index(row, column))) {
+          continue;
+        }
+        selectedCells.setBit(cellIndex, argSelect);
+        selectedCount += argSelect ? 1 : -1;
+      }
+    }
+  }
+}
+
+/*!
+ * \brief Return all selected clients in the grid's row-major order
+ *
+ * \return The selected clients
+ */
+QVector<lc::Client *> lc::ClientSelection::GetSelectedClients() const {
+  QVector<Client *> selectedClients;
+  selectedClients.reserve(selectedCount);
+  const int columns = model->columnCount();
+  for (int cellIndex = 0;
+       cellIndex < selectedCells.size() && selectedClients.size() < selectedCount;
+       ++cellIndex) {
+    if (selectedCells.testBit(cellIndex)) {
+      selectedClients.append(model->GetClient(
+          model->index(cellIndex / columns, cellIndex % columns)));
+    }
+  }
+  return selectedClients;
+}
+
+/*!
+ * \brief Drop selected cells which no longer hold a client
+ *
+ * \param[in] argTopLeft The top left cell of the changed area
+ * \param[in] argBottomRight The bottom right cell of the changed area
+ */
+void lc::ClientSelection::GotDataChanged(const QModelIndex &argTopLeft,
+                                         const QModelIndex &argBottomRight) {
+  const int columns = model->columnCount();
+  bool changed = false;
+  for (int row = argTopLeft.row(); row <= argBottomRight.row(); ++row) {
+    for (int column = argTopLeft.column(); column <= argBottomRight.column();
+         ++column) {
+      const int cellIndex = row * columns + column;
+      if (selectedCells.testBit(cellIndex) &&
+          !model->GetClient(model->index(row, column))) {
+        selectedCells.clearBit(cellIndex);
+        --selectedCount;
+        changed = true;
+      }
+    }
+  }
+  if (changed) {
+    emit SelectionChanged();
+  }
+}
+
+/*!
+ * \brief Clear the selection if the model was reset
+ *
+ * The selection model clears its selection on resets without notification.
+ */
+void lc::ClientSelection::GotModelReset() {
+  selectedCells = QBitArray{model->rowCount() * model->columnCount()};
+  selectedCount = 0;
+  emit SelectionChanged();
+}
+
+/*!
+ * \brief Update the bit set from the selection model's change notification
+ *
+ * \param[in] argSelected The newly selected cells
+ * \param[in] argDeselected The newly deselected cells
+ */
+void lc::ClientSelection::GotSelectionChanged(
+    const QItemSelection &argSelected, const QItemSelection &argDeselected) {
+  Apply(argDeselected, false);
+  Apply(argSelected, true);
+  emit SelectionChanged();
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLIENTSELECTION_H
+#define CLIENTSELECTION_H
+
+#include <QBitArray>
+#include <QItemSelectionModel>
+#include <QVector>
+
+#include "clientsgridmodel.h"
+
+namespace lc {
+
+/*!
+ * \brief Keeps track of the clients selected in the clients grid
+ *
+ * The selection is mirrored into a bit set over the grid's cells, which is
+ * updated incrementally from the selection model's change notifications. This
+ * way the selected clients can be queried without walking and casting all
+ * selected indices.
+ */
+class ClientSelection : public QObject {
+  Q_OBJECT
+
+public:
+  ClientSelection(ClientsGridModel *argModel,
+                  QItemSelectionModel *argSelectionModel,
+                  QObject *argParent = nullptr);
+
+  QVector<Client *> GetSelectedClients() const;
+  //! Returns the number of currently selected clients
+  int GetSelectedCount() const { return selectedCount; }
+  //! Returns if no client is currently selected
+  bool IsEmpty() const { return selectedCount == 0; }
+
+signals:
+  /*!
+   * \brief Emitted after the set of selected clients changed
+   */
+  void SelectionChanged();
+
+private slots:
+  void GotDataChanged(const QModelIndex &argTopLeft,
+                      const QModelIndex &argBottomRight);
+  void GotModelReset();
+  void GotSelectionChanged(const QItemSelection &argSelected,
+                           const QItemSelection &argDeselected);
+
+private:
+  void Apply(const QItemSelection &argSelection, bool argSelect);
+
+  //! The grid model the selected cells belong to
+  ClientsGridModel *const model = nullptr;
+  //! Set for every selected grid cell holding a client (row-major order)
+  QBitArray selectedCells;
+  //! The number of set bits in 'selectedCells'
+  int selectedCount = 0;
+};
+
+} // namespace lc
+
+#endif // CLIENTSELECTION_H
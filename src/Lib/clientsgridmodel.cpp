@@ -0,0 +1,248 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QBrush>
+
+#include "clientsgridmodel.h"
+
+/*!
+ * \brief Construct a new model placing the clients at their grid positions
+ *
+ * \param[in] argClients The clients which shall be represented
+ * \param[in] argIcons The icons indicating the clients' states (indexed by
+ * 'icons_t')
+ * \param[in] argParent The instance's parent QObject
+ */
+lc::ClientsGridModel::ClientsGridModel(const QVector<Client *> &argClients,
+                                       const QVector<QPixmap> &argIcons,
+                                       QObject *const argParent)
+    : QAbstractTableModel{argParent}, icons{argIcons} {
+  // Determine the extents of all rooms in the order of their first occurrence
+  for (const auto *const client : argClients) {
+    int room = rooms.indexOf(client->room);
+    if (room < 0) {
+      rooms.append(client->room);
+      roomAreas.append(QRect{0, 0, 0, 0});
+      room = rooms.size() - 1;
+    }
+    QRect &area = roomAreas[room];
+    area.setWidth(qMax(area.width(), static_cast<int>(client->xPosition)));
+    area.setHeight(qMax(area.height(), static_cast<int>(client->yPosition)));
+  }
+  for (auto &area : roomAreas) {
+    area.moveLeft(columns);
+    columns += area.width();
+    rows = qMax(rows, area.height());
+  }
+  cells.fill(nullptr, columns * rows);
+
+  for (auto *const client : argClients) {
+    const int column =
+        roomAreas.at(rooms.indexOf(client->room)).left() + client->xPosition - 1;
+    const int cellIndex = (client->yPosition - 1) * columns + column;
+    if (client->xPosition < 1 || client->yPosition < 1 ||
+        cells.at(cellIndex)) {
+      droppedClients.append(client);
+      continue;
+    }
+    cells[cellIndex] = client;
+    cellIndices.insert(client, cellIndex);
+    connect(client, &Client::StateChanged, this,
+            &ClientsGridModel::GotClientStateChanged);
+  }
+}
+
+int lc::ClientsGridModel::columnCount(const QModelIndex &argParent) const {
+  return argParent.isValid() ? 0 : columns;
+}
+
+QVariant lc::ClientsGridModel::data(const QModelIndex &argIndex,
+                                    const int argRole) const {
+  const Client *const client = GetClient(argIndex);
+  if (!client) {
+    return QVariant{};
+  }
+
+  switch (argRole) {
+  case Qt::DisplayRole:
+    return client->name;
+  case StateRole:
+    return static_cast<int>(client->GetClientState());
+  case Qt::BackgroundRole:
+    switch (client->GetClientState()) {
+    case Client::State::RESPONDING:
+      return QBrush{QColor{128, 255, 128, 255}};
+    case Client::State::NOT_RESPONDING:
+      return QBrush{QColor{255, 255, 128, 255}};
+    case Client::State::BOOTING:
+    case Client::State::SHUTTING_DOWN:
+      return QBrush{QColor{128, 128, 255, 255}};
+    case Client::State::ZLEAF_RUNNING:
+      return QBrush{QColor{0, 255, 0, 255}};
+    case Client::State::UNINITIALIZED:
+    case Client::State::ERROR:
+      return QBrush{QColor{255, 128, 128, 255}};
+    }
+    break;
+  case Qt::DecorationRole:
+    switch (client->GetClientState()) {
+    case Client::State::RESPONDING:
+      return icons.at(static_cast<int>(icons_t::ON));
+    case Client::State::NOT_RESPONDING:
+      return icons.at(static_cast<int>(icons_t::OFF));
+    case Client::State::BOOTING:
+      return icons.at(static_cast<int>(icons_t::BOOT));
+    case Client::State::SHUTTING_DOWN:
+      return icons.at(static_cast<int>(icons_t::DOWN));
+    case Client::State::ZLEAF_RUNNING:
+      return icons.at(static_cast<int>(icons_t::ZLEAF));
+    case Client::State::UNINITIALIZED:
+    case Client::State::ERROR:
+      return icons.at(static_cast<int>(icons_t::UNKNOWN));
+    }
+    break;
+  default:
+    break;
+  }
+  return QVariant{};
+}
+
+Qt::ItemFlags lc::ClientsGridModel::flags(const QModelIndex &argIndex) const {
+  // Empty cells cannot be selected
+  if (!GetClient(argIndex)) {
+    return Qt::NoItemFlags;
+  }
+  return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+/*!
+ * \brief Return the client represented by the given cell
+ *
+ * \param[in] argIndex The index of the cell
+ *
+ * \return The client in the cell or 'nullptr' if the cell is empty or invalid
+ */
+lc::Client *
+lc::ClientsGridModel::GetClient(const QModelIndex &argIndex) const {
+  if (!argIndex.isValid() || argIndex.row() >= rows ||
+      argIndex.column() >= columns) {
+    return nullptr;
+  }
+  return cells.at(argIndex.row() * columns + argIndex.column());
+}
+
+/*!
+ * \brief Return the index of the cell representing the given client
+ *
+ * \param[in] argClient The client whose cell shall be returned
+ *
+ * \return The cell's index or an invalid index if the client is not placed
+ */
+QModelIndex lc::ClientsGridModel::GetIndex(const Client *const argClient) const {
+  const int cellIndex = cellIndices.value(argClient, -1);
+  if (cellIndex < 0) {
+    return QModelIndex{};
+  }
+  return index(cellIndex / columns, cellIndex % columns);
+}
+
+/*!
+ * \brief Announce the changed appearance of a client whose state changed
+ *
+ * \param[in] argState The client's new state
+ */
+void lc::ClientsGridModel::GotClientStateChanged(const Client::State argState) {
+  Q_UNUSED(argState);
+  const QModelIndex cell = GetIndex(qobject_cast<Client *>(sender()));
+  if (cell.isValid()) {
+    emit dataChanged(cell, cell,
+                     QVector<int>{} << Qt::BackgroundRole
+                                    << Qt::DecorationRole << StateRole);
+  }
+}
+
+/*!
+ * \brief Return the area the given room occupies in the grid
+ *
+ * \param[in] argRoom The index of the room in 'GetRooms()'
+ *
+ * \return The room's area in columns and rows
+ */
+QRect lc::ClientsGridModel::GetRoomArea(const int argRoom) const {
+  return roomAreas.value(argRoom);
+}
+
+QVariant lc::ClientsGridModel::headerData(const int argSection,
+                                          const Qt::Orientation argOrientation,
+                                          const int argRole) const {
+  Q_UNUSED(argOrientation);
+  if (argRole == Qt::DisplayRole) {
+    return argSection + 1;
+  }
+  return QVariant{};
+}
+
+int lc::ClientsGridModel::rowCount(const QModelIndex &argParent) const {
+  return argParent.isValid() ? 0 : rows;
+}
+
+/*!
+ * \brief Replace the represented clients, e.g. after the settings were reloaded
+ *
+ * If the grid's rooms and extents stay the same, only the cells whose client
+ * changed are announced as changed. Otherwise the model is reset.
+ *
+ * \param[in] argClients The clients which shall be represented from now on
+ */
+void lc::ClientsGridModel::SetClients(const QVector<Client *> &argClients) {
+  ClientsGridModel next{argClients, icons};
+  for (auto it = cellIndices.cbegin(); it != cellIndices.cend(); ++it) {
+    disconnect(it.key(), &Client::StateChanged, this,
+               &ClientsGridModel::GotClientStateChanged);
+  }
+
+  const bool sameGeometry = next.columns == columns && next.rows == rows &&
+                            next.rooms == rooms && next.roomAreas == roomAreas;
+  if (!sameGeometry) {
+    beginResetModel();
+  }
+  const QVector<Client *> previousCells = cells;
+  cells.swap(next.cells);
+  cellIndices.swap(next.cellIndices);
+  droppedClients.swap(next.droppedClients);
+  roomAreas.swap(next.roomAreas);
+  rooms.swap(next.rooms);
+  columns = next.columns;
+  rows = next.rows;
+  for (auto it = cellIndices.cbegin(); it != cellIndices.cend(); ++it) {
+    connect(it.key(), &Client::StateChanged, this,
+            &ClientsGridModel::GotClientStateChanged);
+  }
+  if (!sameGeometry) {
+    endResetModel();
+    return;
+  }
+
+  for (int cellIndex = 0; cellIndex < cells.size(); ++cellIndex) {
+    if (cells.at(cellIndex) != previousCells.at(cellIndex)) {
+      const QModelIndex cell = index(cellIndex / columns, cellIndex % columns);
+      emit dataChanged(cell, cell);
+    }
+  }
+}
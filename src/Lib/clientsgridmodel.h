@@ -0,0 +1,104 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLIENTSGRIDMODEL_H
+#define CLIENTSGRIDMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QPixmap>
+#include <QRect>
+#include <QStringList>
+#include <QVector>
+
+#include "client.h"
+
+enum class icons_t : unsigned short int {
+  UNKNOWN,
+  OFF,
+  DOWN,
+  BOOT,
+  ON,
+  ZLEAF,
+  ICON_QUANTITY
+};
+
+namespace lc {
+
+/*!
+ * \brief Represents the clients at their positions in the lab's grid
+ *
+ * Every cell of the grid holds at most one client. Colours and icons are
+ * derived from the clients' states on demand and only the cells of clients
+ * whose state changed are announced as changed to attached views. If the lab
+ * consists of multiple rooms, their grids are placed side by side.
+ */
+class ClientsGridModel : public QAbstractTableModel {
+  Q_OBJECT
+
+public:
+  //! The role under which the client's state is provided (as integer)
+  static const int StateRole = Qt::UserRole;
+
+  ClientsGridModel(const QVector<Client *> &argClients,
+                   const QVector<QPixmap> &argIcons,
+                   QObject *argParent = nullptr);
+  ClientsGridModel(const ClientsGridModel &) = delete;
+
+  int columnCount(const QModelIndex &argParent = QModelIndex{}) const override;
+  QVariant data(const QModelIndex &argIndex,
+                int argRole = Qt::DisplayRole) const override;
+  Qt::ItemFlags flags(const QModelIndex &argIndex) const override;
+  Client *GetClient(const QModelIndex &argIndex) const;
+  //! Returns the clients which could not be placed due to occupied positions
+  const QVector<Client *> &GetDroppedClients() const { return droppedClients; }
+  QModelIndex GetIndex(const Client *argClient) const;
+  QRect GetRoomArea(int argRoom) const;
+  //! Returns the names of all rooms in the order of their areas in the grid
+  const QStringList &GetRooms() const { return rooms; }
+  QVariant headerData(int argSection, Qt::Orientation argOrientation,
+                      int argRole = Qt::DisplayRole) const override;
+  int rowCount(const QModelIndex &argParent = QModelIndex{}) const override;
+  void SetClients(const QVector<Client *> &argClients);
+
+private slots:
+  void GotClientStateChanged(Client::State argState);
+
+private:
+  //! The clients in row-major order (with 'nullptr' for empty cells)
+  QVector<Client *> cells;
+  //! The indices of all placed clients in 'cells'
+  QHash<const Client *, int> cellIndices;
+  //! The number of columns of the grid
+  int columns = 0;
+  //! The clients which could not be placed due to occupied positions
+  QVector<Client *> droppedClients;
+  //! The icons indicating the clients' states (indexed by 'icons_t')
+  const QVector<QPixmap> icons;
+  //! The areas of all rooms in the grid
+  QVector<QRect> roomAreas;
+  //! The names of all rooms
+  QStringList rooms;
+  //! The number of rows of the grid
+  int rows = 0;
+};
+
+} // namespace lc
+
+#endif // CLIENTSGRIDMODEL_H
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+
+#include <QDebug>
+
+#include "client.h"
+#include "commandexecution.h"
+#include "settings.h"
+
+extern std::unique_ptr<lc::Settings> settings;
+
+/*!
+ * \brief Prepare the execution of a command on the given clients
+ *
+ * \param[in] argClients The clients the command shall be executed on
+ * \param[in] argCommand The command which shall be executed
+ * \param[in] argAsRoot 'true' if the command shall be run as root, 'false' if
+ * it shall be run as the clients' experiment user
+ * \param[in] argParent The instance's parent QObject
+ */
+lc::CommandExecution::CommandExecution(const QVector<Client *> &argClients,
+                                       const QString &argCommand,
+                                       const bool argAsRoot,
+                                       QObject *const argParent)
+    : QObject{argParent}, asRoot{argAsRoot}, clients{argClients},
+      command{argCommand} {
+  for (auto *const client : clients) {
+    results.insert(client, Result{});
+  }
+}
+
+/*!
+ * \brief Start the execution of the command on all clients
+ */
+void lc::CommandExecution::Start() {
+  qDebug() << "Executing command" << command << "on" << clients.size()
+           << "clients without terminal windows";
+  for (auto *const client : clients) {
+    pendingClients.enqueue(client);
+  }
+  if (pendingClients.isEmpty()) {
+    emit AllFinished();
+    return;
+  }
+  while (runningProcesses < maxRunningProcesses && !pendingClients.isEmpty()) {
+    StartNext();
+  }
+}
+
+/*!
+ * \brief Store the outcome of a finished process and start the next one
+ *
+ * \param[in] argClient The client the process executed the command on
+ * \param[in] argProcess The finished process
+ * \param[in] argExitCode The process' exit code
+ */
+void lc::CommandExecution::GotProcessFinished(Client *const argClient,
+                                              QProcess *const argProcess,
+                                              const int argExitCode) {
+  // Fetch output which was not yet signalled
+  GotProcessOutput(argClient, argProcess);
+  argProcess->deleteLater();
+  --runningProcesses;
+
+  Result &result = results[argClient];
+  result.exitCode = argExitCode;
+  result.finished = true;
+  emit ClientFinished(argClient, argExitCode);
+
+  if (!pendingClients.isEmpty()) {
+    StartNext();
+  } else if (!runningProcesses) {
+    emit AllFinished();
+  }
+}
+
+/*!
+ * \brief Collect and signal the output a process wrote so far
+ *
+ * \param[in] argClient The client the process executes the command on
+ * \param[in] argProcess The process which wrote the output
+ */
+void lc::CommandExecution::GotProcessOutput(Client *const argClient,
+                                            QProcess *const argProcess) {
+  const QString output{QString::fromLocal8Bit(argProcess->readAll())};
+  if (output.isEmpty()) {
+    return;
+  }
+  results[argClient].output.append(output);
+  emit OutputRead(argClient, output);
+}
+
+/*!
+ * \brief Start the command on the next pending client
+ */
+void lc::CommandExecution::StartNext() {
+  Client *const client = pendingClients.dequeue();
+
+  QStringList arguments{"-o", "ConnectTimeout=5", "-o", "BatchMode=yes"};
+  if (asRoot) {
+    arguments << "-i" << settings->pkeyPathRoot << QString{"root@" + client->ip};
+  } else {
+    arguments << "-i" << settings->pkeyPathUser
+              << QString{settings->userNameOnClients + "@" + client->ip};
+  }
+  arguments << command;
+
+  QProcess *const process = new QProcess{this};
+  process->setProcessEnvironment(QProcessEnvironment::systemEnvironment());
+  process->setProcessChannelMode(QProcess::MergedChannels);
+  connect(process, &QProcess::readyRead, this,
+          [this, client, process]() { GotProcessOutput(client, process); });
+  connect(process,
+          static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(
+              &QProcess::finished),
+          this, [this, client, process](int argExitCode) {
+            GotProcessFinished(client, process, argExitCode);
+          });
+  connect(process, &QProcess::errorOccurred, this,
+          [this, client, process](QProcess::ProcessError argError) {
+            if (argError == QProcess::FailedToStart) {
+              GotProcessFinished(client, process, -1);
+            }
+          });
+
+  ++runningProcesses;
+  process->start(settings->sshCmd, arguments);
+  // Remote commands never read input, so ssh must not wait for any
+  process->closeWriteChannel();
+  qDebug() << settings->sshCmd << arguments.join(" ");
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMMANDEXECUTION_H
+#define COMMANDEXECUTION_H
+
+#include <QHash>
+#include <QProcess>
+#include <QQueue>
+#include <QVector>
+
+namespace lc {
+
+class Client;
+
+/*!
+ * \brief Executes a command on multiple clients without terminal windows
+ *
+ * The command is run via 'ssh' on every given client, with a bounded number of
+ * concurrently running connections. The output of every client is streamed via
+ * signals and collected, so that it can be displayed in one aggregated view.
+ */
+class CommandExecution : public QObject {
+  Q_OBJECT
+
+public:
+  //! The outcome of the command's execution on a single client
+  struct Result {
+    //! The merged standard output and standard error of the command
+    QString output;
+    //! The exit code of the command (only valid if 'finished' is set)
+    int exitCode = -1;
+    //! Set as soon as the command finished on the client
+    bool finished = false;
+  };
+
+  CommandExecution(const QVector<Client *> &argClients,
+                   const QString &argCommand, bool argAsRoot,
+                   QObject *argParent = nullptr);
+
+  const QVector<Client *> &GetClients() const { return clients; }
+  const QString &GetCommand() const { return command; }
+  Result GetResult(Client *argClient) const {
+    return results.value(argClient);
+  }
+  void Start();
+
+signals:
+  /*!
+   * \brief Emitted if the command finished on all clients
+   */
+  void AllFinished();
+  /*!
+   * \brief Emitted if the command finished on a client
+   *
+   * \param argClient The client the command finished on
+   * \param argExitCode The command's exit code on the client
+   */
+  void ClientFinished(lc::Client *argClient, int argExitCode);
+  /*!
+   * \brief Emitted if the command wrote output on a client
+   *
+   * \param argClient The client the output stems from
+   * \param argOutput The output which was read
+   */
+  void OutputRead(lc::Client *argClient, const QString &argOutput);
+
+private:
+  void GotProcessFinished(Client *argClient, QProcess *argProcess,
+                          int argExitCode);
+  void GotProcessOutput(Client *argClient, QProcess *argProcess);
+  void StartNext();
+
+  //! Set if the command shall be executed as root on the clients
+  const bool asRoot = false;
+  //! The clients the command shall be executed on
+  const QVector<Client *> clients;
+  //! The command which shall be executed
+  const QString command;
+  //! The maximum number of concurrently running 'ssh' processes
+  const int maxRunningProcesses = 16;
+  //! The clients on which the command was not yet started
+  QQueue<Client *> pendingClients;
+  //! The collected outcomes of the command per client
+  QHash<Client *, Result> results;
+  //! The number of currently running 'ssh' processes
+  int runningProcesses = 0;
+};
+
+} // namespace lc
+
+#endif // COMMANDEXECUTION_H
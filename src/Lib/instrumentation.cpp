@@ -0,0 +1,204 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QAbstractButton>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextStream>
+
+#include "instrumentation.h"
+
+namespace {
+//! The interval of the lag probe in milliseconds
+const int lagProbeInterval = 100;
+//! Lags and handler durations above this (in milliseconds) are logged
+const double stallThreshold = 50.0;
+
+/*!
+ * \brief Append the statistics of all given measurements to a report
+ *
+ * \param[in] argStatistics The statistics per measured name
+ * \param[out] argReport The report the statistics shall be appended to
+ */
+void AppendStatistics(
+    const QHash<QString, lc::Instrumentation::Statistics> &argStatistics,
+    QString &argReport) {
+  QStringList names = argStatistics.keys();
+  names.sort();
+  for (const auto &name : names) {
+    const lc::Instrumentation::Statistics &statistics = argStatistics[name];
+    argReport.append(
+        QString{"  %1: %2 call(s), mean %3 ms, maximum %4 ms, %5 overrun(s)\n"}
+            .arg(name)
+            .arg(statistics.count)
+            .arg(statistics.total / statistics.count, 0, 'f', 1)
+            .arg(statistics.maximum, 0, 'f', 1)
+            .arg(statistics.overruns));
+  }
+}
+} // namespace
+
+/*!
+ * \brief Start measuring the event loop's lag
+ *
+ * \param[in] argLogFilePath The file notable measurements shall be appended to
+ * \param[in] argParent The instance's parent QObject
+ */
+lc::Instrumentation::Instrumentation(const QString &argLogFilePath,
+                                     QObject *const argParent)
+    : QObject{argParent}, logFile{argLogFilePath} {
+  QDir{}.mkpath(QFileInfo{argLogFilePath}.absolutePath());
+  if (!logFile.open(QIODevice::Append | QIODevice::Text)) {
+    qWarning() << "Could not open instrumentation log" << argLogFilePath;
+  } else {
+    qDebug() << "Writing instrumentation log to" << argLogFilePath;
+  }
+
+  lagProbe.setTimerType(Qt::PreciseTimer);
+  connect(&lagProbe, &QTimer::timeout, this, &Instrumentation::GotLagProbe);
+  lagProbe.start(lagProbeInterval);
+  sinceLastProbe.start();
+}
+
+/*!
+ * \brief Summarize all measurements
+ *
+ * \return A human readable report of all measurements
+ */
+QString lc::Instrumentation::CreateReport() const {
+  QString report;
+  report.append(
+      tr("Event loop lag: %1 probe(s), maximum %2 ms, %3 above %4 ms\n\n")
+          .arg(lagStatistics.count)
+          .arg(lagStatistics.maximum, 0, 'f', 1)
+          .arg(lagStatistics.overruns)
+          .arg(stallThreshold));
+  report.append(tr("Button handlers (overrun: above %1 ms):\n")
+                    .arg(stallThreshold));
+  AppendStatistics(handlerStatistics, report);
+  report.append(tr("\nTimers (overrun: handling took longer than the "
+                   "interval):\n"));
+  AppendStatistics(timerStatistics, report);
+  return report;
+}
+
+/*!
+ * \brief Measure how late the lag probe fired
+ */
+void lc::Instrumentation::GotLagProbe() {
+  const double lag =
+      sinceLastProbe.nsecsElapsed() / 1000000.0 - lagProbeInterval;
+  sinceLastProbe.restart();
+  const bool stalled = lag > stallThreshold;
+  Update(lagStatistics, qMax(0.0, lag), stalled);
+  if (stalled) {
+    Log("lag", "event loop", lag);
+  }
+}
+
+/*!
+ * \brief Append a measurement to the log file
+ *
+ * \param[in] argKind The kind of the measurement
+ * \param[in] argName The name of the measured handler or timer
+ * \param[in] argDuration The measured duration in milliseconds
+ */
+void lc::Instrumentation::Log(const QString &argKind, const QString &argName,
+                              const double argDuration) {
+  if (!logFile.isOpen()) {
+    return;
+  }
+  QTextStream stream{&logFile};
+  stream << QDateTime::currentDateTime().toString("yyyy-MM-ddThh:mm:ss.zzz") << '\t'
+         << argKind << '\t' << argName << '\t'
+         << QString::number(argDuration, 'f', 1) << " ms\n";
+  stream.flush();
+}
+
+/*!
+ * \brief Evaluate the delivery of an event to its receiver
+ *
+ * \param[in] argReceiver The receiver of the event
+ * \param[in] argEventType The type of the delivered event
+ * \param[in] argNanoseconds The time the delivery took in nanoseconds
+ */
+void lc::Instrumentation::RecordEventDelivery(QObject *const argReceiver,
+                                              const QEvent::Type argEventType,
+                                              const qint64 argNanoseconds) {
+  const double duration = argNanoseconds / 1000000.0;
+  switch (argEventType) {
+  case QEvent::KeyRelease:
+  case QEvent::MouseButtonRelease: {
+    // Releasing a button triggers its 'clicked' signal and thereby its handler
+    const QAbstractButton *const button =
+        qobject_cast<QAbstractButton *>(argReceiver);
+    if (!button || !button->objectName().startsWith("PB")) {
+      return;
+    }
+    const QString name{"on_" + button->objectName() + "_clicked"};
+    const bool stalled = duration > stallThreshold;
+    Update(handlerStatistics[name], duration, stalled);
+    if (stalled) {
+      Log("handler", name, duration);
+    }
+    break;
+  }
+  case QEvent::Timer: {
+    const QTimer *const timer = qobject_cast<QTimer *>(argReceiver);
+    if (!timer || timer == &lagProbe) {
+      return;
+    }
+    const QObject *const owner = timer->parent();
+    const QString name =
+        QString{"%1::%2 (%3 ms)"}
+            .arg(owner ? owner->metaObject()->className() : "-")
+            .arg(timer->objectName().isEmpty() ? QString{"QTimer"}
+                                               : timer->objectName())
+            .arg(timer->interval());
+    const bool overrun = duration > timer->interval();
+    Update(timerStatistics[name], duration, overrun);
+    if (overrun) {
+      Log("timer overrun", name, duration);
+    }
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+/*!
+ * \brief Add a measurement to the given statistics
+ *
+ * \param[in,out] argStatistics The statistics to be updated
+ * \param[in] argDuration The measured duration in milliseconds
+ * \param[in] argOverrun 'true' if the measurement exceeded its limit
+ */
+void lc::Instrumentation::Update(Statistics &argStatistics,
+                                 const double argDuration,
+                                 const bool argOverrun) {
+  ++argStatistics.count;
+  if (argOverrun) {
+    ++argStatistics.overruns;
+  }
+  argStatistics.maximum = qMax(argStatistics.maximum, argDuration);
+  argStatistics.total += argDuration;
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QFile>
+#include <QHash>
+#include <QTimer>
+
+namespace lc {
+
+/*!
+ * \brief Measures where the graphical user interface stalls
+ *
+ * A probe timer measures how late the event loop processes it (the event
+ * loop's lag). Additionally the delivery times of events are reported by the
+ * application: the time the 'on_PB*' handlers take is derived from the
+ * delivery of the release events to their buttons and timer overruns from the
+ * delivery of timer events to QTimer instances. Notable measurements are
+ * appended to a log file.
+ */
+class Instrumentation : public QObject {
+  Q_OBJECT
+
+public:
+  //! Aggregated durations of a kind of measurement
+  struct Statistics {
+    //! The number of measurements
+    int count = 0;
+    //! The number of measurements exceeding their limit
+    int overruns = 0;
+    //! The longest measured duration in milliseconds
+    double maximum = 0.0;
+    //! The sum of all measured durations in milliseconds
+    double total = 0.0;
+  };
+
+  explicit Instrumentation(const QString &argLogFilePath,
+                           QObject *argParent = nullptr);
+
+  QString CreateReport() const;
+  void RecordEventDelivery(QObject *argReceiver, QEvent::Type argEventType,
+                           qint64 argNanoseconds);
+
+private slots:
+  void GotLagProbe();
+
+private:
+  void Log(const QString &argKind, const QString &argName, double argDuration);
+  static void Update(Statistics &argStatistics, double argDuration,
+                     bool argOverrun);
+
+  //! The durations of the 'on_PB*' handlers per handler
+  QHash<QString, Statistics> handlerStatistics;
+  //! The event loop's lag in milliseconds
+  Statistics lagStatistics;
+  //! Periodically checks how late the event loop processes timers
+  QTimer lagProbe;
+  //! Measures the time since the last lag probe
+  QElapsedTimer sinceLastProbe;
+  //! The file notable measurements are appended to
+  QFile logFile;
+  //! The durations of the handling of timeouts per timer
+  QHash<QString, Statistics> timerStatistics;
+};
+
+} // namespace lc
+
+#endif // INSTRUMENTATION_H
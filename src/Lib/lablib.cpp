@@ -25,33 +25,25 @@
 #include "lablib.h"
 
 lc::Lablib::Lablib(QObject *argParent)
-    : QObject{argParent}, labSettings{"Labcontrol", "Labcontrol", this},
-      sessionsModel{new SessionsModel{this}} {
-  for (const auto &s : settings->GetClients()) {
-    connect(this, &Lablib::ZLEAF_RUNNING, s, &Client::SetStateToZLEAF_RUNNING);
-  }
+    : QObject{argParent}, bootScheduler{new BootScheduler{this}},
+      labSettings{"Labcontrol", "Labcontrol", this},
+      sessionsModel{new SessionsModel{this}},
+      settingsReloader{new SettingsReloader{this}},
+      zLeafStartTracer{new ZLeafStartTracer{settings->GetClients(), this}} {
   DetectInstalledZTreeVersionsAndLaTeXHeaders();
 
-  // Initialize all 'netstat' query mechanisms
-  if (!settings->netstatCmd.isEmpty()) {
-    netstatAgent = new NetstatAgent{settings->netstatCmd};
-    netstatAgent->moveToThread(&netstatThread);
-    connect(&netstatThread, &QThread::finished, netstatAgent,
-            &QObject::deleteLater);
-    connect(netstatAgent, &NetstatAgent::QueryFinished, this,
-            &Lablib::GotNetstatQueryResult);
-    netstatThread.start();
-    netstatTimer = new QTimer{this};
-    connect(netstatTimer, &QTimer::timeout, netstatAgent,
-            &NetstatAgent::QueryClientConnections);
-    netstatTimer->start(500);
-  }
+  // The 'netstat' query mechanisms wait for the verified 'netstat' command
+  connect(settings.get(), &Settings::DeferredChecksFinished, this,
+          &Lablib::GotDeferredChecksFinished);
 
   // Initialize the server for client help requests retrieval
   if (settings->clientHelpNotificationServerPort &&
       !settings->serverIP.isEmpty()) {
     clientHelpNotificationServer = new ClientHelpNotificationServer{this};
   }
+
+  connect(settingsReloader, &SettingsReloader::SettingsReloaded, this,
+          &Lablib::GotSettingsReloaded);
 }
 
 lc::Lablib::~Lablib() {
@@ -76,17 +68,58 @@ bool lc::Lablib::CheckIfUserIsAdmin() const {
 
 void lc::Lablib::DetectInstalledZTreeVersionsAndLaTeXHeaders() {}
 
+/*!
+ * \brief Start or stop the 'netstat' queries depending on the checked command
+ */
+void lc::Lablib::GotDeferredChecksFinished() {
+  if (!settings->IsPathAvailable(settings->netstatCmd)) {
+    if (netstatTimer) {
+      netstatTimer->stop();
+    }
+    return;
+  }
+
+  if (!netstatAgent) {
+    netstatAgent = new NetstatAgent{settings->netstatCmd};
+    netstatAgent->moveToThread(&netstatThread);
+    connect(&netstatThread, &QThread::finished, netstatAgent,
+            &QObject::deleteLater);
+    connect(netstatAgent, &NetstatAgent::QueryFinished, this,
+            &Lablib::GotNetstatQueryResult);
+    netstatThread.start();
+    netstatTimer = new QTimer{this};
+    connect(netstatTimer, &QTimer::timeout, netstatAgent,
+            &NetstatAgent::QueryClientConnections);
+  } else {
+    // The agent lives in its own thread, so the command is passed queued
+    QMetaObject::invokeMethod(netstatAgent, "SetNetstatCommand",
+                              Qt::QueuedConnection,
+                              Q_ARG(QString, settings->netstatCmd));
+  }
+  netstatTimer->start(500);
+}
+
 void lc::Lablib::GotNetstatQueryResult(QStringList *argActiveZLeafConnections) {
   if (argActiveZLeafConnections != nullptr) {
-    for (auto s : *argActiveZLeafConnections) {
+    for (const auto &s : *argActiveZLeafConnections) {
       // Set all given clients' statuses to 'ZLEAF_RUNNING'
-      emit ZLEAF_RUNNING(s);
+      Client *const client = settings->GetClientByIP(s);
+      if (client) {
+        client->SetStateToZLEAF_RUNNING(s);
+      }
     }
   } else
     qDebug() << "Netstat status query failed.";
   delete argActiveZLeafConnections;
 }
 
+void lc::Lablib::GotSettingsReloaded() {
+  zLeafStartTracer->Observe(settings->GetClients());
+  // The new settings re-run the checks before the 'netstat' command is used
+  connect(settings.get(), &Settings::DeferredChecksFinished, this,
+          &Lablib::GotDeferredChecksFinished);
+}
+
 void lc::Lablib::ShowOrsee() {
   QProcess showOrseeProcess;
   QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
@@ -116,55 +149,13 @@ void lc::Lablib::StartNewSession(QVector<Client *> argAssocCl,
                                  QString argParticipNameReplacement,
                                  bool argPrintLocalReceipts,
                                  QString argReceiptsHeader,
-                                 QString argzTreeDataTargetPath,
-                                 quint16 argzTreePort,
+                                 QString argSessionPath, quint16 argzTreePort,
                                  QString argzTreeVersion) {
-  if (!QDir(argzTreeDataTargetPath).exists()) {
-    QMessageBox messageBox{QMessageBox::Critical,
-                           tr("Data target path does not exist"),
-                           tr("Your chosen data target path does not exist."
-                              " Do you want it to be created automatically?"),
-                           QMessageBox::Yes | QMessageBox::No};
-    messageBox.exec();
-    if (messageBox.clickedButton() == messageBox.button(QMessageBox::No)) {
-      QMessageBox messageBox{
-          QMessageBox::Critical,
-          tr("Data target directory will not"
-             " be created"),
-          tr("Your chosen data target directory does not exist and"
-             " will not be created. Please choose another one."),
-          QMessageBox::Ok};
-      messageBox.exec();
-      return;
-    } else {
-      if (!QDir().mkpath(argzTreeDataTargetPath)) {
-        QMessageBox messageBox{
-            QMessageBox::Critical,
-            tr("Data target directory could"
-               " not be created"),
-            tr("Your chosen data target directory does not exist"
-               " and could not be created. Please choose another"
-               " one."),
-            QMessageBox::Ok};
-        messageBox.exec();
-        return;
-      }
-    }
-  }
-  try {
-    sessionsModel->push_back(
-        new Session{std::move(argAssocCl), argzTreeDataTargetPath, argzTreePort,
-                    argzTreeVersion, argPrintLocalReceipts,
-                    argParticipNameReplacement, argReceiptsHeader});
-    occupiedPorts.append(sessionsModel->back()->zTreePort);
-  } catch (Session::lcDataTargetPathCreationFailed) {
-    QMessageBox::information(
-        nullptr, tr("Chosen data target path could not be created"),
-        tr("The path specified by your chosen data target path '%1'"
-           " could not be created. Please check if it is a valid"
-           " location and you have all needed permissions.")
-            .arg(argzTreeDataTargetPath));
-  }
+  sessionsModel->push_back(
+      new Session{std::move(argAssocCl), argSessionPath, argzTreePort,
+                  argzTreeVersion, argPrintLocalReceipts,
+                  argParticipNameReplacement, argReceiptsHeader});
+  occupiedPorts.append(sessionsModel->back()->zTreePort);
 }
 
 void lc::Lablib::SetLocalZLeafDefaultName(const QString &argName) {
@@ -37,12 +37,15 @@
 #include <QVector>
 #include <QXmlStreamReader>
 
+#include "bootscheduler.h"
 #include "client.h"
 #include "clienthelpnotificationserver.h"
 #include "netstatagent.h"
 #include "session.h"
 #include "sessionsmodel.h"
 #include "settings.h"
+#include "settingsreloader.h"
+#include "zleafstarttracer.h"
 
 extern std::unique_ptr<lc::Settings> settings;
 
@@ -71,6 +74,12 @@ public:
    * administrative rights; false, otherwise
    */
   bool CheckIfUserIsAdmin() const;
+  //! Returns the scheduler booting the clients in waves
+  BootScheduler *GetBootScheduler() const { return bootScheduler; }
+  //! Returns the server receiving help requests ('nullptr' if deactivated)
+  ClientHelpNotificationServer *GetClientHelpNotificationServer() const {
+    return clientHelpNotificationServer;
+  }
   /** Returns a pointer to a QVector<unsigned int> containing all by sessions
    * occupied ports
    *
@@ -82,6 +91,10 @@ public:
    * @return A pointer to the QAbstractTableModel storing the Session instances
    */
   SessionsModel *GetSessionsModel() const { return sessionsModel; }
+  //! Returns the reloader replacing the settings if they were modified
+  SettingsReloader *GetSettingsReloader() const { return settingsReloader; }
+  //! Returns the tracer recording the durations of all z-Leaf starts
+  ZLeafStartTracer *GetZLeafStartTracer() const { return zLeafStartTracer; }
   //! Sets the default name of local zLeaf instances
   /**
    * @param argName   The default name local zLeaf instances shall have
@@ -89,10 +102,16 @@ public:
   void SetLocalZLeafDefaultName(const QString &argName);
   void ShowOrsee();
   void ShowPreprints();
+  /*!
+   * \brief Creates a new session in an already created session directory
+   *
+   * This never interacts with the user nor the file system, SessionStarter
+   * validates the start and creates the session's directory beforehand.
+   */
   void StartNewSession(QVector<Client *> argAssocCl,
                        QString argParticipNameReplacement,
                        bool argPrintLocalReceipts, QString argReceiptsHeader,
-                       QString argzTreeDataTargetPath, quint16 argzTreePort,
+                       QString argSessionPath, quint16 argzTreePort,
                        QString argzTreeVersion);
 
   /*!
@@ -105,12 +124,13 @@ public:
 
 public slots:
 
-signals:
-  void ZLEAF_RUNNING(QString argClientIP);
-
 private slots:
+  //! Starts the 'netstat' queries once their command was checked
+  void GotDeferredChecksFinished();
   //! Gets the output from NetstatAgent
   void GotNetstatQueryResult(QStringList *argActiveZLeafConnections);
+  //! Applies reloaded settings to the lab's background machinery
+  void GotSettingsReloaded();
 
 private:
   //! Detects installed zTree version and LaTeX headers
@@ -119,6 +139,8 @@ private:
    */
   void ReadSettings();
 
+  BootScheduler *bootScheduler =
+      nullptr; //! Boots the clients in waves to avoid overloading the servers
   ClientHelpNotificationServer *clientHelpNotificationServer =
       nullptr; //! A server to retrieve help requests from the clients
   QSettings labSettings;
@@ -131,6 +153,10 @@ private:
   SessionsModel *sessionsModel =
       nullptr; //! A derivation from QAbstractTableModel used to store the
                //! single Session instances
+  SettingsReloader *settingsReloader =
+      nullptr; //! Reloads the settings if 'Labcontrol.conf' was modified
+  ZLeafStartTracer *zLeafStartTracer =
+      nullptr; //! Traces the time z-Leaf starts take until they connect
 };
 
 } // namespace lc
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QFileInfo>
+#include <QSet>
+#include <QStandardPaths>
+
+#include "latexformatcache.h"
+
+namespace {
+//! The paths of the formats being built (only used by the GUI thread)
+QSet<QString> buildingFormats;
+} // namespace
+
+/*!
+ * \brief Construct a cache for the format of the given header
+ *
+ * \param[in] argHeaderPath The path of the '*_header.tex' file
+ */
+lc::LaTeXFormatCache::LaTeXFormatCache(const QString &argHeaderPath)
+    : formatDirectory{QStandardPaths::writableLocation(
+                          QStandardPaths::CacheLocation) +
+                      "/latex_formats"},
+      formatName{QFileInfo{argHeaderPath}.completeBaseName()},
+      headerPath{argHeaderPath} {}
+
+lc::LaTeXFormatCache::~LaTeXFormatCache() { SetBuilding(false); }
+
+/*!
+ * \brief Return the arguments letting 'latex' dump the header's preamble
+ */
+QStringList lc::LaTeXFormatCache::GetBuildArguments() const {
+  return QStringList{} << "-ini"
+                       << "-interaction=batchmode"
+                       << QString{"-jobname=" + formatName}
+                       << QString{"-output-directory=" + formatDirectory}
+                       << "&latex"
+                       << "mylatexformat.ltx" << headerPath;
+}
+
+/*!
+ * \brief Return the arguments letting 'latex' compile with the format
+ *
+ * The format is found via the environment returned by GetEnvironment().
+ */
+QStringList lc::LaTeXFormatCache::GetCompileArguments() const {
+  return QStringList{} << QString{"-fmt=" + formatName};
+}
+
+/*!
+ * \brief Extend the given environment by the directory of the formats
+ *
+ * \param[in] argEnvironment The environment 'latex' would be run in otherwise
+ *
+ * \return The environment 'latex' shall be run in to find the format
+ */
+QProcessEnvironment lc::LaTeXFormatCache::GetEnvironment(
+    const QProcessEnvironment &argEnvironment) const {
+  QProcessEnvironment environment{argEnvironment};
+  // The trailing separator keeps the default search path
+  environment.insert("TEXFORMATS",
+                     formatDirectory + ":" +
+                         argEnvironment.value("TEXFORMATS"));
+  return environment;
+}
+
+/*!
+ * \brief Check if any job is building the format at the moment
+ */
+bool lc::LaTeXFormatCache::IsBeingBuilt() const {
+  return buildingFormats.contains(formatDirectory + "/" + formatName);
+}
+
+/*!
+ * \brief Check if the format was built after the header's last modification
+ */
+bool lc::LaTeXFormatCache::IsUpToDate() const {
+  const QFileInfo formatInfo{formatDirectory + "/" + formatName + ".fmt"};
+  return formatInfo.exists() &&
+         formatInfo.lastModified() >= QFileInfo{headerPath}.lastModified();
+}
+
+/*!
+ * \brief Mark the format as being built by this instance's job or release it
+ *
+ * \param[in] argBuilding True, if the job starts building the format
+ */
+void lc::LaTeXFormatCache::SetBuilding(const bool argBuilding) {
+  if (argBuilding == building) {
+    return;
+  }
+  building = argBuilding;
+  if (building) {
+    buildingFormats.insert(formatDirectory + "/" + formatName);
+  } else {
+    buildingFormats.remove(formatDirectory + "/" + formatName);
+  }
+}
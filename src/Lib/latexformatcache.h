@@ -0,0 +1,69 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LATEXFORMATCACHE_H
+#define LATEXFORMATCACHE_H
+
+#include <QProcessEnvironment>
+#include <QString>
+#include <QStringList>
+
+namespace lc {
+
+/*!
+ * \brief Caches precompiled LaTeX formats of the receipts' headers
+ *
+ * Loading the packages of a header's preamble dominates the time 'latex'
+ * needs for the receipts. Therefore the preamble is dumped once into a format
+ * using 'mylatexformat', which is rebuilt only if the header was modified
+ * after the format was built. Documents compiled with the format skip their
+ * preamble, so the receipts look exactly as before. Only one job builds a
+ * format at a time, while it is written the other jobs compile without it.
+ */
+class LaTeXFormatCache {
+public:
+  explicit LaTeXFormatCache(const QString &argHeaderPath);
+  LaTeXFormatCache(const LaTeXFormatCache &argCache) = delete;
+  LaTeXFormatCache &operator=(const LaTeXFormatCache &argCache) = delete;
+  ~LaTeXFormatCache();
+
+  QStringList GetBuildArguments() const;
+  QStringList GetCompileArguments() const;
+  QProcessEnvironment
+  GetEnvironment(const QProcessEnvironment &argEnvironment) const;
+  //! Returns the directory the formats are stored in
+  const QString &GetFormatDirectory() const { return formatDirectory; }
+  bool IsBeingBuilt() const;
+  bool IsUpToDate() const;
+  void SetBuilding(bool argBuilding);
+
+private:
+  //! Set while this instance's job builds the format
+  bool building = false;
+  //! The directory the formats are stored in
+  const QString formatDirectory;
+  //! The name of the header's format (without the '.fmt' suffix)
+  const QString formatName;
+  //! The path of the header the format is built from
+  const QString headerPath;
+};
+
+} // namespace lc
+
+#endif // LATEXFORMATCACHE_H
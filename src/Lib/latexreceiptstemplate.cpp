@@ -0,0 +1,227 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QTextStream>
+
+#include "latexreceiptstemplate.h"
+#include "settings.h"
+
+extern std::unique_ptr<lc::Settings> settings;
+
+namespace {
+const QString comprehensionBegin{"\n\\COMPREHENSION{\n"};
+const QString comprehensionEnd{"}{"};
+const QString receiptsBegin{"}\n\n%%Einzelquittungen\n"};
+const QString documentEnd{"\\end{document}"};
+const QString rowColor{"\\rowcolor[gray]{0.9}\n"};
+} // namespace
+
+const lc::LaTeXReceiptsTemplate::Pattern
+    lc::LaTeXReceiptsTemplate::overviewRow{"%1 & %2 & %3 & %4 \\EUR\\\\\n"};
+const lc::LaTeXReceiptsTemplate::Pattern
+    lc::LaTeXReceiptsTemplate::gainReceipt{"\\GAINRECEIPT{%1}{%2}{%3}{%4}\n"};
+const lc::LaTeXReceiptsTemplate::Pattern
+    lc::LaTeXReceiptsTemplate::lossReceipt{"\\LOSSRECEIPT{%1}{%2}{%3}{%4}\n"};
+
+lc::LaTeXReceiptsTemplate::LaTeXReceiptsTemplate(
+    const QString &argHeader, const QDateTime &argLastModified)
+    : header{argHeader}, lastModified{argLastModified} {}
+
+/*!
+ * \brief Build the TeX file of the receipts of one or more payment files
+ *
+ * Every section consists of its overview followed by its single receipts.
+ *
+ * \param[in] argSections The sections in the order they shall be listed
+ *
+ * \return The TeX file's content
+ */
+QString lc::LaTeXReceiptsTemplate::Build(
+    const QVector<receiptsSection_t> &argSections) const {
+  // The overviews and the receipts share the formatted payoffs
+  QVector<QVector<QString>> payoffs;
+  payoffs.reserve(argSections.size());
+  QVector<QString> totalPayoffs;
+  totalPayoffs.reserve(argSections.size());
+  for (const auto &section : argSections) {
+    Q_ASSERT(section.overview.size() == section.receipts.size());
+    QVector<QString> sectionPayoffs;
+    sectionPayoffs.reserve(section.overview.size());
+    for (const auto &entry : section.overview) {
+      sectionPayoffs.append(QString::number(entry.payoff, 'f', 2));
+    }
+    payoffs.append(sectionPayoffs);
+    totalPayoffs.append(QString::number(section.totalPayoff, 'f', 2));
+  }
+
+  // Measure the document, so that its buffer is allocated only once
+  int size = header.size() + documentEnd.size();
+  for (int s = 0; s < argSections.size(); ++s) {
+    const receiptsSection_t &section = argSections.at(s);
+    size += comprehensionBegin.size() + comprehensionEnd.size() +
+            totalPayoffs.at(s).size() + receiptsBegin.size();
+    for (int i = 0; i < section.overview.size(); ++i) {
+      const SlotValues values{{&section.experiment,
+                               &section.overview[i].computer,
+                               &section.overview[i].name, &payoffs[s][i]}};
+      size +=
+          overviewRow.GetSize(values) + (i % 2 == 0 ? rowColor.size() : 0);
+    }
+    for (int i = 0; i < section.receipts.size(); ++i) {
+      const SlotValues values{{&section.experiment,
+                               &section.receipts[i].computer,
+                               &section.receipts[i].name, &payoffs[s][i]}};
+      size += (section.receipts[i].payoff >= 0 ? gainReceipt : lossReceipt)
+                  .GetSize(values);
+    }
+  }
+
+  QString document;
+  document.reserve(size);
+  document.append(header);
+  for (int s = 0; s < argSections.size(); ++s) {
+    const receiptsSection_t &section = argSections.at(s);
+
+    // Write the comprehension table
+    document.append(comprehensionBegin);
+    for (int i = 0; i < section.overview.size(); ++i) {
+      const SlotValues values{{&section.experiment,
+                               &section.overview[i].computer,
+                               &section.overview[i].name, &payoffs[s][i]}};
+      overviewRow.AppendTo(document, values);
+      if (i % 2 == 0) {
+        document.append(rowColor);
+      }
+    }
+    document.append(comprehensionEnd);
+    document.append(totalPayoffs.at(s));
+    document.append(receiptsBegin);
+
+    // Write the single receipts
+    for (int i = 0; i < section.receipts.size(); ++i) {
+      const SlotValues values{{&section.experiment,
+                               &section.receipts[i].computer,
+                               &section.receipts[i].name, &payoffs[s][i]}};
+      (section.receipts[i].payoff >= 0 ? gainReceipt : lossReceipt)
+          .AppendTo(document, values);
+    }
+  }
+  document.append(documentEnd);
+
+  return document;
+}
+
+/*!
+ * \brief Return the path of the given template's LaTeX header
+ *
+ * \param[in] argTemplateName The name of the receipts template
+ */
+QString
+lc::LaTeXReceiptsTemplate::GetHeaderPath(const QString &argTemplateName) {
+  return settings->lcDataDir + "/" + argTemplateName + "_header.tex";
+}
+
+/*!
+ * \brief Return the template of the given header, reading it if needed
+ *
+ * \param[in] argHeaderPath The path of the '*_header.tex' file
+ *
+ * \return The template or nullptr, if the header could not be read
+ */
+std::shared_ptr<const lc::LaTeXReceiptsTemplate>
+lc::LaTeXReceiptsTemplate::Load(const QString &argHeaderPath) {
+  static QHash<QString, std::shared_ptr<const LaTeXReceiptsTemplate>> cache;
+
+  const QDateTime lastModified{QFileInfo{argHeaderPath}.lastModified()};
+  const auto cached = cache.constFind(argHeaderPath);
+  if (cached != cache.constEnd() &&
+      (*cached)->lastModified == lastModified) {
+    return *cached;
+  }
+
+  QFile headerFile{argHeaderPath};
+  if (!headerFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    cache.remove(argHeaderPath);
+    return nullptr;
+  }
+  QTextStream in{&headerFile};
+  const std::shared_ptr<const LaTeXReceiptsTemplate> loaded{
+      new LaTeXReceiptsTemplate{in.readAll(), lastModified}};
+  cache.insert(argHeaderPath, loaded);
+  return loaded;
+}
+
+/*!
+ * \brief Split the pattern at its placeholders
+ *
+ * \param[in] argPattern The line with the placeholders '%1' to '%4' for the
+ * slots in their order
+ */
+lc::LaTeXReceiptsTemplate::Pattern::Pattern(const QString &argPattern) {
+  QString literal;
+  for (int i = 0; i < argPattern.size(); ++i) {
+    const int slot = i + 1 < argPattern.size() && argPattern[i] == '%'
+                         ? argPattern[i + 1].digitValue() - 1
+                         : -1;
+    if (slot >= 0 && slot < SLOT_COUNT) {
+      segments.append(Segment{literal, static_cast<Slot>(slot)});
+      literal.clear();
+      ++i;
+    } else {
+      literal.append(argPattern[i]);
+    }
+  }
+  segments.append(Segment{literal, SLOT_COUNT});
+}
+
+/*!
+ * \brief Append the pattern with the given values substituted
+ *
+ * \param[in,out] argTarget The string the line is appended to
+ * \param[in] argValues The values of the slots
+ */
+void lc::LaTeXReceiptsTemplate::Pattern::AppendTo(
+    QString &argTarget, const SlotValues &argValues) const {
+  for (const auto &segment : segments) {
+    argTarget.append(segment.literal);
+    if (segment.slot != SLOT_COUNT) {
+      argTarget.append(*argValues[segment.slot]);
+    }
+  }
+}
+
+/*!
+ * \brief Return the length of the line with the given values substituted
+ *
+ * \param[in] argValues The values of the slots
+ */
+int lc::LaTeXReceiptsTemplate::Pattern::GetSize(
+    const SlotValues &argValues) const {
+  int size = 0;
+  for (const auto &segment : segments) {
+    size += segment.literal.size();
+    if (segment.slot != SLOT_COUNT) {
+      size += argValues[segment.slot]->size();
+    }
+  }
+  return size;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LATEXRECEIPTSTEMPLATE_H
+#define LATEXRECEIPTSTEMPLATE_H
+
+#include <array>
+#include <memory>
+
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+
+#include "paymentfile.h"
+
+namespace lc {
+
+/*!
+ * \brief A LaTeX receipts header from which the receipts' TeX file is built
+ *
+ * Headers are read only once and kept in a cache keyed by their path and
+ * modification time, so that modified headers are picked up. The lines
+ * filled in per participant are split into literals and substitution slots
+ * once. The document is then built by measuring its size first and
+ * appending everything into a single buffer of that size.
+ */
+class LaTeXReceiptsTemplate {
+public:
+  //! The values which can be substituted into the per participant lines
+  enum Slot { PAYMENT_FILE, COMPUTER, NAME, PAYOFF, SLOT_COUNT };
+  //! The values of all slots
+  using SlotValues = std::array<const QString *, SLOT_COUNT>;
+
+  QString Build(const QVector<receiptsSection_t> &argSections) const;
+  static QString GetHeaderPath(const QString &argTemplateName);
+  static std::shared_ptr<const LaTeXReceiptsTemplate>
+  Load(const QString &argHeaderPath);
+
+private:
+  /*!
+   * \brief A line with '%1' to '%4' placeholders compiled into segments
+   */
+  class Pattern {
+  public:
+    explicit Pattern(const QString &argPattern);
+
+    void AppendTo(QString &argTarget, const SlotValues &argValues) const;
+    int GetSize(const SlotValues &argValues) const;
+
+  private:
+    //! A literal followed by a slot (or none, if 'slot' is SLOT_COUNT)
+    struct Segment {
+      QString literal;
+      Slot slot;
+    };
+
+    //! The segments the pattern consists of
+    QVector<Segment> segments;
+  };
+
+  LaTeXReceiptsTemplate(const QString &argHeader,
+                        const QDateTime &argLastModified);
+
+  //! A row of the overview table
+  static const Pattern overviewRow;
+  //! A receipt of a participant who gained money
+  static const Pattern gainReceipt;
+  //! A receipt of a participant who lost money
+  static const Pattern lossReceipt;
+
+  //! The header's content
+  const QString header;
+  //! The modification time of the header when it was read
+  const QDateTime lastModified;
+};
+
+} // namespace lc
+
+#endif // LATEXRECEIPTSTEMPLATE_H
@@ -31,6 +31,10 @@ lc::NetstatAgent::NetstatAgent(const QString &argNetstatCommand,
   netstatQueryProcess.setProcessEnvironment(env);
 }
 
+void lc::NetstatAgent::SetNetstatCommand(const QString &argNetstatCommand) {
+  netstatCommand = argNetstatCommand;
+}
+
 void lc::NetstatAgent::QueryClientConnections() {
   netstatQueryProcess.start(netstatCommand, netstatArguments);
   if (!netstatQueryProcess.waitForFinished(400)) {
@@ -46,11 +46,13 @@ signals:
 
 public slots:
   void QueryClientConnections();
+  //! Replaces the command queried, e.g. after the settings were reloaded
+  void SetNetstatCommand(const QString &argNetstatCommand);
 
 private:
   const QRegularExpression extractionRegexp;
   const QStringList netstatArguments;
-  const QString &netstatCommand;
+  QString netstatCommand;
   QProcess netstatQueryProcess;
   const QRegularExpression searchRegexp;
 };
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include <QByteArray>
+#include <QFile>
+
+#include "paymentfile.h"
+
+namespace {
+//! The fields of a participant's line are SUBJECT, COMPUTER, INTERESTED, NAME,
+//! PROFIT and SIGNATURE, the first five are needed
+const int neededFields = 5;
+} // namespace
+
+/*!
+ * \brief Read the participants' entries from a payment file
+ *
+ * \param[in] argPath The path of the payment file
+ *
+ * \return The read entries and all encountered problems
+ */
+lc::PaymentFile lc::PaymentFile::Read(const QString &argPath) {
+  PaymentFile paymentFile;
+  QFile file{argPath};
+  if (!file.open(QIODevice::ReadOnly)) {
+    paymentFile.errors.append(
+        QString{"The payment file '%1' could not be opened"}.arg(argPath));
+    return paymentFile;
+  }
+  paymentFile.readable = true;
+
+  const qint64 size = file.size();
+  uchar *const mapping = size > 0 ? file.map(0, size) : nullptr;
+  if (mapping) {
+    paymentFile.Parse(reinterpret_cast<const char *>(mapping), size);
+    file.unmap(mapping);
+  } else {
+    const QByteArray content = file.readAll();
+    paymentFile.Parse(content.constData(), content.size());
+  }
+  return paymentFile;
+}
+
+/*!
+ * \brief Parse the content of a payment file
+ *
+ * The first line holds the column headers and the last one the totals, so
+ * both are skipped.
+ *
+ * \param[in] argData The content of the payment file
+ * \param[in] argSize The size of the content in bytes
+ */
+void lc::PaymentFile::Parse(const char *const argData, const qint64 argSize) {
+  // Find the beginning of the last line, ignoring trailing line breaks
+  const char *contentEnd = argData + argSize;
+  while (contentEnd > argData &&
+         (contentEnd[-1] == '\n' || contentEnd[-1] == '\r')) {
+    --contentEnd;
+  }
+  const char *lastLine = contentEnd;
+  while (lastLine > argData && lastLine[-1] != '\n') {
+    --lastLine;
+  }
+
+  const char *lineBegin = static_cast<const char *>(
+      std::memchr(argData, '\n', static_cast<std::size_t>(argSize)));
+  if (!lineBegin) {
+    errors.append(QString{"Line 1: The header is not terminated"});
+    return;
+  }
+  ++lineBegin;
+  int lineNumber = 2;
+  while (lineBegin < lastLine) {
+    const char *lineEnd = static_cast<const char *>(std::memchr(
+        lineBegin, '\n', static_cast<std::size_t>(lastLine - lineBegin)));
+    if (!lineEnd) {
+      lineEnd = lastLine;
+    }
+    const char *fieldsEnd = lineEnd;
+    if (fieldsEnd > lineBegin && fieldsEnd[-1] == '\r') {
+      --fieldsEnd;
+    }
+    if (fieldsEnd > lineBegin) {
+      ParseLine(lineBegin, fieldsEnd, lineNumber);
+    }
+    lineBegin = lineEnd + 1;
+    ++lineNumber;
+  }
+}
+
+/*!
+ * \brief Tokenize a participant's line and append its entry
+ *
+ * \param[in] argBegin The first character of the line
+ * \param[in] argEnd The position after the line's last character
+ * \param[in] argLineNumber The line's number in the file (starting at 1)
+ */
+void lc::PaymentFile::ParseLine(const char *const argBegin,
+                                const char *const argEnd,
+                                const int argLineNumber) {
+  const char *fields[neededFields];
+  int fieldLengths[neededFields];
+  int fieldCount = 0;
+  const char *fieldBegin = argBegin;
+  while (fieldCount < neededFields) {
+    const char *fieldEnd = static_cast<const char *>(std::memchr(
+        fieldBegin, '\t', static_cast<std::size_t>(argEnd - fieldBegin)));
+    if (!fieldEnd) {
+      fieldEnd = argEnd;
+    }
+    fields[fieldCount] = fieldBegin;
+    fieldLengths[fieldCount] = static_cast<int>(fieldEnd - fieldBegin);
+    ++fieldCount;
+    if (fieldEnd == argEnd) {
+      break;
+    }
+    fieldBegin = fieldEnd + 1;
+  }
+  if (fieldCount < neededFields) {
+    errors.append(QString{"Line %1: Only %2 of %3 needed fields were found"}
+                      .arg(argLineNumber)
+                      .arg(fieldCount)
+                      .arg(neededFields));
+    return;
+  }
+
+  bool ok = false;
+  const double payoff =
+      QByteArray::fromRawData(fields[4], fieldLengths[4]).trimmed().toDouble(
+          &ok);
+  if (!ok) {
+    errors.append(QString{"Line %1: The profit '%2' is not a number"}
+                      .arg(argLineNumber)
+                      .arg(QString::fromLatin1(fields[4], fieldLengths[4])));
+    return;
+  }
+  // z-Tree writes the payment files encoded in ISO 8859-1
+  entries.append(paymentEntry_t{
+      QString::fromLatin1(fields[1], fieldLengths[1]),
+      QString::fromLatin1(fields[3], fieldLengths[3]), payoff});
+}
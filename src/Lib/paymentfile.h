@@ -0,0 +1,91 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PAYMENTFILE_H
+#define PAYMENTFILE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace lc {
+
+//! A struct representing one payoff entry.
+/*!
+  This class represents a single payoff entry which will be used in the receipts
+  creation process. Multiple instances of this will be used to represent the
+  individual participants' outcomes.
+*/
+struct paymentEntry_t {
+  QString computer;
+  QString name;
+  double payoff;
+};
+
+//! The receipts created from one payment file
+/*!
+  Documents merging the receipts of multiple payment files consist of one such
+  section per payment file.
+*/
+struct receiptsSection_t {
+  //! The name of the payment file, shown as experiment
+  QString experiment;
+  //! The entries listed in the overview
+  QVector<paymentEntry_t> overview;
+  //! The entries a receipt shall be created for (in the overview's order)
+  QVector<paymentEntry_t> receipts;
+  //! The sum of all payoffs
+  double totalPayoff;
+};
+
+/*!
+ * \brief The participants' entries of a z-Tree payment file
+ *
+ * The file is read in a single pass over a memory mapping (or a single buffer
+ * if mapping fails). The tab-separated fields are tokenized in place and only
+ * the needed ones are converted. Malformed lines are skipped and reported
+ * with their line numbers.
+ */
+class PaymentFile {
+public:
+  PaymentFile() = default;
+
+  static PaymentFile Read(const QString &argPath);
+
+  const QVector<paymentEntry_t> &GetEntries() const { return entries; }
+  //! Returns descriptions of all problems encountered while reading the file
+  const QStringList &GetErrors() const { return errors; }
+  //! Returns if the file could be read at all
+  bool IsReadable() const { return readable; }
+
+private:
+  void Parse(const char *argData, qint64 argSize);
+  void ParseLine(const char *argBegin, const char *argEnd, int argLineNumber);
+
+  //! The entries of all well-formed participant lines in the file's order
+  QVector<paymentEntry_t> entries;
+  //! Descriptions of all problems encountered while reading the file
+  QStringList errors;
+  //! Set if the file could be opened and read
+  bool readable = false;
+};
+
+} // namespace lc
+
+#endif // PAYMENTFILE_H
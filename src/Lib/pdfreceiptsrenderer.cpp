@@ -0,0 +1,283 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocale>
+#include <QPdfWriter>
+
+#include "pdfreceiptsrenderer.h"
+#include "settings.h"
+
+extern std::unique_ptr<lc::Settings> settings;
+
+namespace {
+//! The resolution the PDF is rendered with (in dots per inch)
+const int resolution = 300;
+//! The number of dots per millimeter at the rendering resolution
+const qreal mm = resolution / 25.4;
+//! The relative widths of the tables' columns
+const qreal columnWidths[] = {0.3, 0.2, 0.3, 0.2};
+} // namespace
+
+/*!
+ * \brief Load the receipts template from its description
+ *
+ * \param[in] argTemplatePath The path of the '*_receipt.json' file
+ */
+lc::PdfReceiptsRenderer::PdfReceiptsRenderer(const QString &argTemplatePath) {
+  QFile templateFile{argTemplatePath};
+  if (!templateFile.open(QIODevice::ReadOnly)) {
+    error = QString{"The receipts template '%1' could not be opened"}.arg(
+        argTemplatePath);
+    return;
+  }
+  QJsonParseError parseError;
+  const QJsonDocument document{
+      QJsonDocument::fromJson(templateFile.readAll(), &parseError)};
+  if (!document.isObject()) {
+    error = QString{"The receipts template '%1' is malformed: %2"}
+                .arg(argTemplatePath)
+                .arg(parseError.errorString());
+    return;
+  }
+
+  const QJsonObject description{document.object()};
+  for (const auto &line : description.value("organization").toArray()) {
+    organization.append(line.toString());
+  }
+  currency = description.value("currency").toString("EUR");
+  place = description.value("place").toString();
+  const QJsonObject columns{description.value("columns").toObject()};
+  computerColumn = columns.value("computer").toString("Computer");
+  experimentColumn = columns.value("experiment").toString("Experiment");
+  gainColumn = columns.value("gain").toString("Payout");
+  lossColumn = columns.value("loss").toString("Deposit");
+  nameColumn = columns.value("name").toString("Name");
+  const QJsonObject gain{description.value("gain").toObject()};
+  gainText = gain.value("text").toString();
+  gainTitle = gain.value("title").toString("Receipt");
+  const QJsonObject loss{description.value("loss").toObject()};
+  lossSignatory = loss.value("signatory").toString();
+  lossText = loss.value("text").toString();
+  lossTitle = loss.value("title").toString("Receipt");
+}
+
+/*!
+ * \brief Draw the organization's lines and the bar below them
+ *
+ * \param[in] argPainter The painter drawing the current page
+ * \param[in] argWidth The width of the page's printable area
+ *
+ * \return The vertical position below the header
+ */
+qreal lc::PdfReceiptsRenderer::DrawHeader(QPainter &argPainter,
+                                          const qreal argWidth) const {
+  QFont font{argPainter.font()};
+  font.setPointSizeF(14.0);
+  argPainter.setFont(font);
+  const qreal lineHeight = argPainter.fontMetrics().height();
+  qreal y = 0.0;
+  for (const auto &line : organization) {
+    argPainter.drawText(QRectF{argWidth / 2.0, y, argWidth / 2.0, lineHeight},
+                        Qt::AlignLeft | Qt::AlignVCenter, line);
+    y += lineHeight;
+  }
+  y += 2.0 * mm;
+  argPainter.fillRect(QRectF{0.0, y, argWidth, 2.0 * mm}, Qt::black);
+  font.setPointSizeF(11.0);
+  argPainter.setFont(font);
+  return y + 12.0 * mm;
+}
+
+/*!
+ * \brief Draw a single receipt on the current page
+ *
+ * \param[in] argPainter The painter drawing the current page
+ * \param[in] argWidth The width of the page's printable area
+ * \param[in] argExperiment The experiment's name (the payment file's name)
+ * \param[in] argEntry The participant's entry
+ */
+void lc::PdfReceiptsRenderer::DrawReceipt(
+    QPainter &argPainter, const qreal argWidth, const QString &argExperiment,
+    const paymentEntry_t &argEntry) const {
+  const bool isGain = argEntry.payoff >= 0;
+  qreal y = DrawHeader(argPainter, argWidth) + 20.0 * mm;
+
+  QFont font{argPainter.font()};
+  font.setBold(true);
+  argPainter.setFont(font);
+  argPainter.drawText(QPointF{0.0, y}, isGain ? gainTitle : lossTitle);
+  font.setBold(false);
+  argPainter.setFont(font);
+  y += 8.0 * mm;
+
+  y = DrawRow(argPainter, y, argWidth,
+              QStringList{} << experimentColumn << computerColumn << nameColumn
+                            << (isGain ? gainColumn : lossColumn),
+              false);
+  argPainter.drawLine(QPointF{0.0, y}, QPointF{argWidth, y});
+  y = DrawRow(argPainter, y, argWidth,
+              QStringList{} << argExperiment << argEntry.computer
+                            << argEntry.name << FormatPayoff(argEntry.payoff),
+              false);
+  y += 8.0 * mm;
+
+  QRectF textRect{0.0, y, argWidth, 80.0 * mm};
+  argPainter.drawText(textRect, Qt::TextWordWrap, isGain ? gainText : lossText,
+                      &textRect);
+  y = textRect.bottom() + 20.0 * mm;
+
+  const QString date{QLocale{}.toString(QDate::currentDate(),
+                                        QLocale::ShortFormat)};
+  argPainter.drawText(QPointF{0.0, y},
+                      place.isEmpty() ? date : place + ", " + date);
+  argPainter.drawLine(QPointF{argWidth / 2.0, y}, QPointF{argWidth, y});
+  argPainter.drawText(QPointF{argWidth / 2.0,
+                              y + argPainter.fontMetrics().height()},
+                      isGain ? argEntry.name : lossSignatory);
+}
+
+/*!
+ * \brief Draw a row of a table
+ *
+ * \param[in] argPainter The painter drawing the current page
+ * \param[in] argY The vertical position of the row's top
+ * \param[in] argWidth The width of the page's printable area
+ * \param[in] argCells The texts of the row's four cells
+ * \param[in] argShaded If the row's background shall be shaded
+ *
+ * \return The vertical position below the row
+ */
+qreal lc::PdfReceiptsRenderer::DrawRow(QPainter &argPainter, const qreal argY,
+                                       const qreal argWidth,
+                                       const QStringList &argCells,
+                                       const bool argShaded) const {
+  const qreal rowHeight = argPainter.fontMetrics().height() * 1.4;
+  if (argShaded) {
+    argPainter.fillRect(QRectF{0.0, argY, argWidth, rowHeight},
+                        QColor{230, 230, 230});
+  }
+  qreal x = 0.0;
+  for (int i = 0; i < argCells.size(); ++i) {
+    const qreal cellWidth = columnWidths[i] * argWidth;
+    // The payoffs in the last column are right-aligned
+    const Qt::Alignment alignment{(i == argCells.size() - 1 ? Qt::AlignRight
+                                                            : Qt::AlignLeft) |
+                                  Qt::AlignVCenter};
+    argPainter.drawText(
+        QRectF{x + 1.0 * mm, argY, cellWidth - 2.0 * mm, rowHeight},
+        static_cast<int>(alignment), argCells.at(i));
+    x += cellWidth;
+  }
+  return argY + rowHeight;
+}
+
+QString lc::PdfReceiptsRenderer::FormatPayoff(const double argPayoff) const {
+  return QString::number(argPayoff, 'f', 2) + " " + currency;
+}
+
+/*!
+ * \brief Return the path of the description of the given receipts template
+ *
+ * \param[in] argTemplateName The name of the template (as chosen in the GUI)
+ *
+ * \return The path of the template's description (which may not exist)
+ */
+QString
+lc::PdfReceiptsRenderer::GetTemplatePath(const QString &argTemplateName) {
+  return settings->lcDataDir + "/" + argTemplateName + "_receipt.json";
+}
+
+/*!
+ * \brief Render the receipts of one or more payment files into a PDF file
+ *
+ * Every section starts on a new page with its overview, followed by its
+ * single receipts.
+ *
+ * \param[in] argPDFPath The path the PDF file shall be written to
+ * \param[in] argSections The sections in the order they shall be rendered
+ *
+ * \return True, if the PDF file was written; false, otherwise
+ */
+bool lc::PdfReceiptsRenderer::Render(
+    const QString &argPDFPath,
+    const QVector<receiptsSection_t> &argSections) const {
+  QPdfWriter writer{argPDFPath};
+  writer.setCreator("Labcontrol");
+  writer.setPageSize(QPageSize{QPageSize::A4});
+  writer.setPageMargins(QMarginsF{20.0, 15.0, 20.0, 15.0},
+                        QPageLayout::Millimeter);
+  writer.setResolution(resolution);
+  QPainter painter;
+  if (!painter.begin(&writer)) {
+    return false;
+  }
+  const qreal width = writer.width();
+  const qreal height = writer.height();
+  const QDateTime now{QDateTime::currentDateTime()};
+  const QStringList columns{QStringList{} << experimentColumn << computerColumn
+                                          << nameColumn << gainColumn};
+
+  for (int s = 0; s < argSections.size(); ++s) {
+    const receiptsSection_t &section = argSections.at(s);
+    if (s > 0) {
+      writer.newPage();
+    }
+
+    // The overview, continued on further pages if it does not fit on one
+    qreal y = DrawHeader(painter, width);
+    painter.drawText(QPointF{0.0, y},
+                     QLocale{}.toString(now, QLocale::LongFormat));
+    y += 10.0 * mm;
+    y = DrawRow(painter, y, width, columns, false);
+    painter.drawLine(QPointF{0.0, y}, QPointF{width, y});
+    const qreal rowHeight = painter.fontMetrics().height() * 1.4;
+    for (int i = 0; i < section.overview.size(); ++i) {
+      if (y + 2.0 * rowHeight > height) {
+        writer.newPage();
+        y = DrawRow(painter, DrawHeader(painter, width), width, columns,
+                    false);
+        painter.drawLine(QPointF{0.0, y}, QPointF{width, y});
+      }
+      const paymentEntry_t &entry = section.overview.at(i);
+      y = DrawRow(painter, y, width,
+                  QStringList{} << section.experiment << entry.computer
+                                << entry.name << FormatPayoff(entry.payoff),
+                  i % 2 == 1);
+    }
+    painter.drawLine(QPointF{0.0, y}, QPointF{width, y});
+    DrawRow(painter, y, width,
+            QStringList{} << QString{} << QString{} << QString{}
+                          << FormatPayoff(section.totalPayoff),
+            false);
+
+    // A page per receipt
+    for (const auto &entry : section.receipts) {
+      writer.newPage();
+      DrawReceipt(painter, width, section.experiment, entry);
+    }
+  }
+  return painter.end();
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PDFRECEIPTSRENDERER_H
+#define PDFRECEIPTSRENDERER_H
+
+#include <QPainter>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "paymentfile.h"
+
+namespace lc {
+
+/*!
+ * \brief Renders the receipts directly as PDF file
+ *
+ * The texts of the receipts are read from a template description in the
+ * Labcontrol data directory named '<template>_receipt.json'. Rendering with
+ * QPdfWriter takes a fraction of the time the LaTeX tool chain needs, which
+ * remains in use for templates given as '<template>_header.tex' only.
+ */
+class PdfReceiptsRenderer {
+public:
+  explicit PdfReceiptsRenderer(const QString &argTemplatePath);
+
+  //! Returns the reason why the template could not be loaded
+  const QString &GetError() const { return error; }
+  static QString GetTemplatePath(const QString &argTemplateName);
+  //! Returns if the template was loaded successfully
+  bool IsValid() const { return error.isEmpty(); }
+  bool Render(const QString &argPDFPath,
+              const QVector<receiptsSection_t> &argSections) const;
+
+private:
+  qreal DrawHeader(QPainter &argPainter, qreal argWidth) const;
+  void DrawReceipt(QPainter &argPainter, qreal argWidth,
+                   const QString &argExperiment,
+                   const paymentEntry_t &argEntry) const;
+  qreal DrawRow(QPainter &argPainter, qreal argY, qreal argWidth,
+                const QStringList &argCells, bool argShaded) const;
+  QString FormatPayoff(double argPayoff) const;
+
+  //! The column titles of the tables
+  QString computerColumn;
+  QString currency;
+  //! Set if the template could not be loaded
+  QString error;
+  QString experimentColumn;
+  QString gainColumn;
+  //! The text confirming the payment of a gain
+  QString gainText;
+  QString gainTitle;
+  QString lossColumn;
+  //! The person signing the receipts of losses
+  QString lossSignatory;
+  //! The text confirming the payment of a loss
+  QString lossText;
+  QString lossTitle;
+  QString nameColumn;
+  //! The lines naming the organization at the top of every page
+  QStringList organization;
+  //! The place written beside the date above the signature
+  QString place;
+};
+
+} // namespace lc
+
+#endif // PDFRECEIPTSRENDERER_H
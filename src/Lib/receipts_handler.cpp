@@ -20,10 +20,14 @@
 #include <memory>
 
 #include <QDebug>
+#include <QDir>
+#include <QFileInfo>
 
 #include "receipts_handler.h"
 #include "settings.h"
 
+extern std::unique_ptr<lc::ReceiptsJournal> receiptsJournal;
+extern std::unique_ptr<lc::ReceiptsScheduler> receiptsScheduler;
 extern std::unique_ptr<lc::Settings> settings;
 
 lc::ReceiptsHandler::ReceiptsHandler(
@@ -32,19 +36,32 @@ lc::ReceiptsHandler::ReceiptsHandler(
     const QString &argLatexHeaderName, QObject *argParent)
     : QObject{argParent},
       anonymousReceiptsPlaceholder{argAnonymousReceiptsPlaceholder},
-      dateString{QDateTime::currentDateTime().toString("yyMMdd_hhmm")},
-      expectedPaymentFileName{dateString + ".pay"},
-      expectedPaymentFilePath{argZTreeDataTargetPath + "/" + dateString +
-                              ".pay"},
-      latexHeaderName{argLatexHeaderName}, paymentFile{expectedPaymentFilePath},
+      latexHeaderName{argLatexHeaderName},
       printReceiptsForLocalClients{argPrintReceiptsForLocalClients},
-      timer{new QTimer{this}}, zTreeDataTargetPath{argZTreeDataTargetPath} {
-  qDebug() << "Expected payment file name is:" << expectedPaymentFilePath;
-
-  // Create a QTimer regularly checking if the payment file was created and
-  // print it if so
-  connect(timer, &QTimer::timeout, this, &ReceiptsHandler::PrintReceipts);
-  timer->start(2000);
+      priority{ReceiptsScheduler::Priority::HIGH},
+      settleTimer{new QTimer{this}},
+      watcher{new QFileSystemWatcher{this}},
+      zTreeDataTargetPath{argZTreeDataTargetPath} {
+  qDebug() << "Watching for payment files in:" << zTreeDataTargetPath;
+
+  // Watch the data target path for the creation of payment files and the
+  // payment files themselves for writes. Every payment file written during
+  // the session is printed, so that restarted treatments get their receipts,
+  // too. Those of earlier sessions sharing the directory are left alone
+  for (const auto &fileName :
+       QDir{zTreeDataTargetPath, "*.pay", QDir::Name, QDir::Files}
+           .entryList()) {
+    processedPaymentFiles.insert(zTreeDataTargetPath + "/" + fileName);
+  }
+  settleTimer->setInterval(300);
+  settleTimer->setSingleShot(true);
+  connect(settleTimer, &QTimer::timeout, this,
+          &ReceiptsHandler::CheckPendingPaymentFiles);
+  connect(watcher, &QFileSystemWatcher::directoryChanged, this,
+          &ReceiptsHandler::GotPaymentFileChanged);
+  connect(watcher, &QFileSystemWatcher::fileChanged, this,
+          &ReceiptsHandler::GotPaymentFileChanged);
+  watcher->addPath(zTreeDataTargetPath);
 }
 
 lc::ReceiptsHandler::ReceiptsHandler(
@@ -54,131 +71,139 @@ lc::ReceiptsHandler::ReceiptsHandler(
     QObject *argParent)
     : QObject{argParent},
       anonymousReceiptsPlaceholder{argAnonymousReceiptsPlaceholder},
-      dateString{argDateString}, expectedPaymentFileName{argDateString +
-                                                         ".pay"},
-      expectedPaymentFilePath{argZTreeDataTargetPath + "/" + argDateString +
-                              ".pay"},
-      latexHeaderName{argLatexHeaderName}, paymentFile{expectedPaymentFilePath},
+      latexHeaderName{argLatexHeaderName},
       printReceiptsForLocalClients{argPrintReceiptsForLocalClients},
+      priority{ReceiptsScheduler::Priority::NORMAL},
       zTreeDataTargetPath{argZTreeDataTargetPath} {
-  qDebug() << "Expected payment file name is:" << expectedPaymentFilePath;
-
-  PrintReceipts();
+  const QString paymentFilePath{zTreeDataTargetPath + "/" + argDateString +
+                                ".pay"};
+  qDebug() << "Expected payment file name is:" << paymentFilePath;
+
+  if (QFile::exists(paymentFilePath)) {
+    receiptsJournal->RecordDetected(paymentFilePath, latexHeaderName,
+                                    printReceiptsForLocalClients,
+                                    anonymousReceiptsPlaceholder);
+    queuedPaymentFiles.append(paymentFilePath);
+    PrintNextPaymentFile();
+  }
 }
 
-void lc::ReceiptsHandler::PrintReceipts() {
-  // If the payment file exists, print it
-  if (paymentFile.exists()) {
-    qDebug() << "The payment file has been created and will be printed";
-    if (timer) {
-      timer->stop();
+void lc::ReceiptsHandler::GotPaymentFileChanged() {
+  const QStringList paymentFiles{
+      QDir{zTreeDataTargetPath, "*.pay", QDir::Name, QDir::Files}.entryList()};
+  for (const auto &fileName : paymentFiles) {
+    const QString path{zTreeDataTargetPath + "/" + fileName};
+    if (!processedPaymentFiles.contains(path) &&
+        !pendingPaymentFiles.contains(path)) {
+      // Receipts already finished by another handler are not redone
+      if (receiptsJournal->IsFinished(path)) {
+        processedPaymentFiles.insert(path);
+        continue;
+      }
+      qDebug() << "Found the new payment file" << path;
+      pendingPaymentFiles.insert(path, -1);
+      watcher->addPath(path);
     }
-
-    CreateReceiptsFromPaymentFile();
   }
-}
-
-void lc::ReceiptsHandler::CreateReceiptsFromPaymentFile() {
-  // Get the data needed for receipts creation from the payment file
-  QVector<QString> *rawParticipantsData = nullptr;
-  rawParticipantsData = GetParticipantsDataFromPaymentFile();
-  for (int i = 0; i < rawParticipantsData->size(); i++) {
-    qDebug() << "Payment file line" << QString::number(i) << ":\t"
-             << rawParticipantsData->at(i);
+  if (!pendingPaymentFiles.isEmpty()) {
+    settleTimer->start();
   }
+}
 
-  // Extract the data of the participant's whose receipts shall be printed
-  /* The tab separated fields in the payment file are:
-   * SUBJECT  COMPUTER    INTERESTED  NAME    PROFIT  SIGNATURE
-   */
-  QVector<paymentEntry_t *> *participants = new QVector<paymentEntry_t *>;
-  double overall_payoff = 0.0;
-  for (QVector<QString>::iterator it = rawParticipantsData->begin();
-       it != rawParticipantsData->end() - 1; ++it) {
-    // Split the lines containing the participants' data into their inidivual
-    // parts
-    QStringList temp_participant_data =
-        it->split('\t', QString::KeepEmptyParts);
-    qDebug() << temp_participant_data.join(" - ");
-    if (!printReceiptsForLocalClients &&
-        temp_participant_data.at(3).contains("local")) {
-      qDebug() << "Receipt for local client" << temp_participant_data.at(1)
-               << "will not be printed.";
+void lc::ReceiptsHandler::CheckPendingPaymentFiles() {
+  for (auto it = pendingPaymentFiles.begin();
+       it != pendingPaymentFiles.end();) {
+    if (IsPaymentFileComplete(it.key(), it.value())) {
+      watcher->removePath(it.key());
+      processedPaymentFiles.insert(it.key());
+      queuedPaymentFiles.append(it.key());
+      receiptsJournal->RecordDetected(it.key(), latexHeaderName,
+                                      printReceiptsForLocalClients,
+                                      anonymousReceiptsPlaceholder);
+      it = pendingPaymentFiles.erase(it);
     } else {
-      // Create a new struct instance for participant data and fill it
-      paymentEntry_t *participant = new paymentEntry_t;
-      participant->computer = temp_participant_data.at(1);
-      participant->name = temp_participant_data.at(3);
-      participant->payoff = temp_participant_data.at(4).toDouble();
-      overall_payoff += participant->payoff;
-      participants->append(participant);
+      ++it;
     }
   }
-  delete rawParticipantsData;
-  rawParticipantsData = nullptr;
-
-  // Make receipts overview anonymous if requested (at this stage just names are
-  // removed, so that the overview still containts the client names
-  if (!anonymousReceiptsPlaceholder.isEmpty()) {
-    MakeReceiptsAnonymous(participants, false);
+  // Check again later for payment files z-Tree is still writing
+  if (!pendingPaymentFiles.isEmpty()) {
+    settleTimer->start();
   }
-
-  // Load the LaTeX header
-  QString *latexText = LoadLatexHeader();
-  if (latexText == nullptr) {
-    for (auto s : *participants) {
-      delete s;
-    }
-    delete participants;
-    participants = nullptr;
-    return;
+  if (!receiptsPrinter) {
+    PrintNextPaymentFile();
   }
+}
 
-  // Write the comprehension table
-  latexText->append("\n\\COMPREHENSION{\n");
-  unsigned short int zeile = 0;
-  for (auto s : *participants) {
-    latexText->append(expectedPaymentFileName + " & " + s->computer + " & " +
-                      s->name + " & " + QString::number(s->payoff, 'f', 2) +
-                      " \\EUR\\\\\n");
-    if (zeile % 2 == 0) {
-      latexText->append("\\rowcolor[gray]{0.9}\n");
+void lc::ReceiptsHandler::PrintNextPaymentFile() {
+  while (!receiptsPrinter && !queuedPaymentFiles.isEmpty()) {
+    const QFileInfo paymentFileInfo{queuedPaymentFiles.takeFirst()};
+    dateString = paymentFileInfo.completeBaseName();
+    paymentFilePath = paymentFileInfo.filePath();
+    qDebug() << "The payment file" << paymentFileInfo.filePath()
+             << "has been created and will be printed";
+
+    // Jobs failing before printing are run again after the next start
+    if (!CreateReceiptsFromPaymentFile()) {
+      receiptsJournal->Record(paymentFileInfo.filePath(),
+                              ReceiptsJournal::State::FAILED);
     }
-    ++zeile;
   }
+}
 
-  // MISSING: Appending show up entries to the overview
-
-  // Make also the clients on the receipts anonymous. This is done as second
-  // step, so that the beforehand created overview still contains the clients
-  if (!anonymousReceiptsPlaceholder.isEmpty()) {
-    MakeReceiptsAnonymous(participants, true);
+/*!
+ * \brief Create the receipts of the current payment file and print them
+ *
+ * \return True, if a ReceiptsPrinter instance was started; false, otherwise
+ */
+bool lc::ReceiptsHandler::CreateReceiptsFromPaymentFile() {
+  // Get the data needed for receipts creation from the payment file
+  receiptsSection_t section;
+  QStringList errors;
+  const bool sectionCreated =
+      CreateReceiptsSection(paymentFilePath, printReceiptsForLocalClients,
+                            anonymousReceiptsPlaceholder, section, &errors);
+  // Nobody may be left out of the payout unnoticed
+  if (!errors.isEmpty()) {
+    QMessageBox messageBox{
+        QMessageBox::Warning, tr("Payment file contains errors"),
+        tr("The following problems were found in the payment file '%1'. "
+           "The participants of unreadable lines are missing from the "
+           "receipts:\n\n%2")
+            .arg(paymentFilePath)
+            .arg(errors.join("\n")),
+        QMessageBox::Ok};
+    messageBox.exec();
+  }
+  if (!sectionCreated) {
+    return false;
   }
 
-  // Add the LaTeX middle sequence
-  latexText->append("}{" + QString::number(overall_payoff, 'f', 2) +
-                    "}\n\n%%Einzelquittungen\n");
-
-  // Write the single receipts
-  for (auto s : *participants) {
-    if (s->payoff >= 0) {
-      latexText->append("\\GAINRECEIPT{" + expectedPaymentFileName + "}{" +
-                        s->computer + "}{" + s->name + "}{" +
-                        QString::number(s->payoff, 'f', 2) + "}\n");
-    } else {
-      latexText->append("\\LOSSRECEIPT{" + expectedPaymentFileName + "}{" +
-                        s->computer + "}{" + s->name + "}{" +
-                        QString::number(s->payoff, 'f', 2) + "}\n");
-    }
-    delete s;
+  // Prefer the native PDF renderer if the template is described for it
+  const QString templatePath{
+      PdfReceiptsRenderer::GetTemplatePath(latexHeaderName)};
+  if (QFile::exists(templatePath)) {
+    return CreateReceiptsNatively(templatePath, section);
   }
-  delete participants;
-  participants = nullptr;
 
-  // Append LaTeX ending
-  latexText->append("\\end{document}");
+  // Load the LaTeX header
+  const QString headerPath{
+      LaTeXReceiptsTemplate::GetHeaderPath(latexHeaderName)};
+  const std::shared_ptr<const LaTeXReceiptsTemplate> latexTemplate{
+      LaTeXReceiptsTemplate::Load(headerPath)};
+  if (!latexTemplate) {
+    QMessageBox messageBox{QMessageBox::Critical,
+                           tr("LaTeX header could not be loaded"),
+                           tr("The LaTeX header at '%1' could not be loaded. "
+                              "Receipts printing will not work.")
+                               .arg(headerPath),
+                           QMessageBox::Ok};
+    messageBox.exec();
+    return false;
+  }
 
-  qDebug() << *latexText;
+  const QString latexText{
+      latexTemplate->Build(QVector<receiptsSection_t>{section})};
+  qDebug() << latexText;
 
   // Create the tex file
   QFile *texFile = new QFile{zTreeDataTargetPath + "/" + dateString + ".tex"};
@@ -204,36 +229,71 @@ void lc::ReceiptsHandler::CreateReceiptsFromPaymentFile() {
             texFile->fileName() + "' failed. Receipts printing will not work.",
         QMessageBox::Ok);
     messageBox.exec();
-    return;
+    return false;
   }
 
   // Open a QTextStream to write to the file
   QTextStream out(texFile);
 
-  out << *latexText;
-  delete latexText;
-  latexText = nullptr;
-
-  receiptsPrinter = new ReceiptsPrinter{dateString, zTreeDataTargetPath, this};
-  receiptsPrinter->start();
-  connect(receiptsPrinter, &ReceiptsPrinter::PrintingFinished, this,
-          &ReceiptsHandler::DeleteReceiptsPrinterInstance);
-  connect(receiptsPrinter, &ReceiptsPrinter::ErrorOccurred, this,
-          &ReceiptsHandler::DisplayMessageBox);
+  out << latexText;
 
   // Clean up
   texFile->close();
   delete texFile;
+
+  StartReceiptsPrinter(false, headerPath);
+  return true;
+}
+
+/*!
+ * \brief Render the receipts as PDF file and print it
+ *
+ * \param[in] argTemplatePath The path of the receipts template's description
+ * \param[in] argSection The receipts created from the payment file
+ *
+ * \return True, if a ReceiptsPrinter instance was started; false, otherwise
+ */
+bool lc::ReceiptsHandler::CreateReceiptsNatively(
+    const QString &argTemplatePath, const receiptsSection_t &argSection) {
+  const PdfReceiptsRenderer renderer{argTemplatePath};
+  if (!renderer.IsValid()) {
+    qWarning() << renderer.GetError();
+    return false;
+  }
+
+  const QString pdfPath{zTreeDataTargetPath + "/" + dateString + ".pdf"};
+  if (!renderer.Render(pdfPath, QVector<receiptsSection_t>{argSection})) {
+    QMessageBox messageBox{
+        QMessageBox::Critical, tr("PDF file creation failed"),
+        tr("The receipts could not be written to '%1'.").arg(pdfPath),
+        QMessageBox::Ok};
+    messageBox.exec();
+    return false;
+  }
+  qDebug() << "Rendered the receipts to" << pdfPath;
+
+  StartReceiptsPrinter(true, QString{});
+  return true;
 }
 
 void lc::ReceiptsHandler::DeleteReceiptsPrinterInstance() {
-  receiptsPrinter->quit();
-  receiptsPrinter->wait();
   receiptsPrinter->deleteLater();
   receiptsPrinter = nullptr;
   qDebug() << "Deleted 'ReceiptsPrinter' instance.";
+  // Without a printer the created document finishes the job
+  const QString documentPath{zTreeDataTargetPath + "/" + dateString};
+  const bool finished =
+      receiptsPrinted ||
+      (!settings->IsPathAvailable(settings->lprCmd) &&
+       (QFile::exists(documentPath + ".pdf") ||
+        QFile::exists(documentPath + ".ps")));
+  // Failed jobs are run again later
+  receiptsJournal->Record(paymentFilePath,
+                          finished ? ReceiptsJournal::State::ARCHIVED
+                                   : ReceiptsJournal::State::FAILED);
 
   emit PrintingFinished();
+  PrintNextPaymentFile();
 }
 
 void lc::ReceiptsHandler::DisplayMessageBox(QString *argErrorMessage,
@@ -245,72 +305,132 @@ void lc::ReceiptsHandler::DisplayMessageBox(QString *argErrorMessage,
   messageBox.exec();
 }
 
-QVector<QString> *lc::ReceiptsHandler::GetParticipantsDataFromPaymentFile() {
-  // Create the vector to store the single lines of the file
-  QVector<QString> *participantsData = new QVector<QString>;
+/*!
+ * \brief Let the lab's receipts scheduler print the rendered receipts
+ *
+ * \param[in] argRenderedNatively If the receipts were rendered as PDF file
+ * \param[in] argLaTeXHeaderPath The LaTeX header of the TeX file (empty if
+ * the receipts were rendered natively)
+ */
+void lc::ReceiptsHandler::StartReceiptsPrinter(
+    const bool argRenderedNatively, const QString &argLaTeXHeaderPath) {
+  receiptsJournal->Record(paymentFilePath, ReceiptsJournal::State::RENDERED);
+  receiptsPrinted = false;
+
+  receiptsPrinter = new ReceiptsPrinter{dateString, zTreeDataTargetPath,
+                                        argRenderedNatively,
+                                        argLaTeXHeaderPath, this};
+  connect(receiptsPrinter, &ReceiptsPrinter::PrintingFinished, this,
+          &ReceiptsHandler::DeleteReceiptsPrinterInstance);
+  connect(receiptsPrinter, &ReceiptsPrinter::ErrorOccurred, this,
+          &ReceiptsHandler::DisplayMessageBox);
+  const QString path{paymentFilePath};
+  connect(receiptsPrinter, &ReceiptsPrinter::Printed, this, [this, path]() {
+    receiptsPrinted = true;
+    receiptsJournal->Record(path, ReceiptsJournal::State::PRINTED);
+  });
+  receiptsScheduler->Submit(receiptsPrinter, priority);
+}
 
-  // Open the payment file for reading and create a QTextStream
-  paymentFile.open(QIODevice::ReadOnly | QIODevice::Text);
-  QTextStream in(&paymentFile);
-  in.setCodec("ISO 8859-1");
+/*!
+ * \brief Read a payment file and prepare the receipts of its participants
+ *
+ * \param[in] argPath The path of the payment file
+ * \param[in] argPrintReceiptsForLocalClients If receipts shall be created for
+ * participants whose names contain 'local'
+ * \param[in] argAnonymousReceiptsPlaceholder The placeholder replacing the
+ * participants' names (empty if the receipts shall not be anonymous)
+ * \param[out] argSection The receipts created from the payment file
+ * \param[out] argErrors If given, receives the problems found in the payment
+ * file, e.g. lines whose participants are missing from the receipts
+ *
+ * \return True, if the payment file could be read; false, otherwise
+ */
+bool lc::ReceiptsHandler::CreateReceiptsSection(
+    const QString &argPath, const bool argPrintReceiptsForLocalClients,
+    const QString &argAnonymousReceiptsPlaceholder,
+    receiptsSection_t &argSection, QStringList *const argErrors) {
+  const PaymentFile paymentFile{PaymentFile::Read(argPath)};
+  for (const auto &error : paymentFile.GetErrors()) {
+    qWarning().noquote() << argPath << "-" << error;
+  }
+  if (argErrors) {
+    *argErrors = paymentFile.GetErrors();
+  }
+  if (!paymentFile.IsReadable()) {
+    return false;
+  }
 
-  // Read the file line by line and store them in the vector
-  while (true) {
-    QString line = in.readLine();
-    if (line.isNull()) {
-      break;
+  // Extract the data of the participant's whose receipts shall be printed
+  argSection.experiment = QFileInfo{argPath}.fileName();
+  argSection.overview.clear();
+  argSection.overview.reserve(paymentFile.GetEntries().size());
+  argSection.totalPayoff = 0.0;
+  for (const auto &entry : paymentFile.GetEntries()) {
+    if (!argPrintReceiptsForLocalClients && entry.name.contains("local")) {
+      qDebug() << "Receipt for local client" << entry.computer
+               << "will not be printed.";
+    } else {
+      argSection.totalPayoff += entry.payoff;
+      argSection.overview.append(entry);
     }
-    participantsData->append(line);
   }
 
-  // Remove the first line, since it is not needed
-  participantsData->erase(participantsData->begin());
+  // Make receipts overview anonymous if requested (at this stage just names are
+  // removed, so that the overview still containts the client names
+  if (!argAnonymousReceiptsPlaceholder.isEmpty()) {
+    MakeReceiptsAnonymous(argSection.overview, argAnonymousReceiptsPlaceholder,
+                          false);
+  }
 
-  // Close the file afterwards
-  paymentFile.close();
+  // MISSING: Appending show up entries to the overview
 
-  return participantsData;
+  // Make also the clients on the receipts anonymous. This is done on a copy,
+  // so that the overview still contains the clients
+  argSection.receipts = argSection.overview;
+  if (!argAnonymousReceiptsPlaceholder.isEmpty()) {
+    MakeReceiptsAnonymous(argSection.receipts,
+                          argAnonymousReceiptsPlaceholder, true);
+  }
+  return true;
 }
 
-QString *lc::ReceiptsHandler::LoadLatexHeader() {
-  // Prepare all facilities to read the latex header file
-  QFile latexHeaderFile(settings->lcDataDir + "/" + latexHeaderName +
-                        "_header.tex");
-  if (!latexHeaderFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-    QMessageBox messageBox{QMessageBox::Critical,
-                           tr("LaTeX header could not be loaded"),
-                           tr("The LaTeX header at '%1/%2_header.tex' could "
-                              "not be loaded. Receipts printing will not work.")
-                               .arg(settings->lcDataDir)
-                               .arg(latexHeaderName),
-                           QMessageBox::Ok};
-    messageBox.exec();
-    return nullptr;
+/*!
+ * \brief Check if z-Tree finished writing a payment file
+ *
+ * A payment file is considered complete if its size did not change since the
+ * last check and it ends with a complete line following the header.
+ *
+ * \param[in] argPath The path of the payment file
+ * \param[in,out] argLastSize The size at the last check, which gets updated
+ * \return True, if the payment file is complete; false, otherwise
+ */
+bool lc::ReceiptsHandler::IsPaymentFileComplete(const QString &argPath,
+                                                qint64 &argLastSize) {
+  const qint64 size = QFileInfo{argPath}.size();
+  const bool sizeStable = size == argLastSize;
+  argLastSize = size;
+  QFile file{argPath};
+  if (!sizeStable || !file.open(QIODevice::ReadOnly)) {
+    return false;
   }
-  QTextStream in(&latexHeaderFile);
-
-  QString *header = nullptr;
-  header = new QString(in.readAll());
-
-  latexHeaderFile.close();
-
-  return header;
+  const QByteArray content = file.readAll();
+  return content.endsWith('\n') && content.count('\n') >= 2;
 }
 
 void lc::ReceiptsHandler::MakeReceiptsAnonymous(
-    QVector<paymentEntry_t *> *argDataVector, bool argAlsoAnonymizeClients) {
+    QVector<paymentEntry_t> &argDataVector, const QString &argPlaceholder,
+    bool argAlsoAnonymizeClients) {
   if (!argAlsoAnonymizeClients) {
     qDebug() << "Names are made anonymous";
-    for (QVector<paymentEntry_t *>::iterator it = argDataVector->begin();
-         it != argDataVector->end(); ++it) {
-      (*it)->name = anonymousReceiptsPlaceholder;
+    for (auto &entry : argDataVector) {
+      entry.name = argPlaceholder;
     }
   } else {
     qDebug() << "Clients and names are made anonymous";
-    for (QVector<paymentEntry_t *>::iterator it = argDataVector->begin();
-         it != argDataVector->end(); ++it) {
-      (*it)->name = anonymousReceiptsPlaceholder;
-      (*it)->computer = "\\hspace{1cm}";
+    for (auto &entry : argDataVector) {
+      entry.name = argPlaceholder;
+      entry.computer = "\\hspace{1cm}";
     }
   }
 }
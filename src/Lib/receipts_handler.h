@@ -22,28 +22,24 @@
 
 #include <QDateTime>
 #include <QFile>
+#include <QFileSystemWatcher>
+#include <QHash>
 #include <QMessageBox>
 #include <QObject>
 #include <QPlainTextEdit>
+#include <QSet>
 #include <QTextStream>
 #include <QTimer>
 
+#include "latexreceiptstemplate.h"
+#include "paymentfile.h"
+#include "pdfreceiptsrenderer.h"
+#include "receiptsjournal.h"
 #include "receiptsprinter.h"
+#include "receiptsscheduler.h"
 
 namespace lc {
 
-//! A struct representing one payoff entry.
-/*!
-  This class represents a single payoff entry which will be used in the receipts
-  creation process. Multiple instances of this will be used to represent the
-  individual participants' outcomes.
-*/
-struct paymentEntry_t {
-  QString computer;
-  QString name;
-  double payoff;
-};
-
 //! A class to handle receipts printing.
 /*!
   This class is element of every session and is used to handle the receipts
@@ -65,6 +61,13 @@ public:
                            const QString &argDateString,
                            QObject *argParent = nullptr);
 
+  static bool
+  CreateReceiptsSection(const QString &argPath,
+                        bool argPrintReceiptsForLocalClients,
+                        const QString &argAnonymousReceiptsPlaceholder,
+                        receiptsSection_t &argSection,
+                        QStringList *argErrors = nullptr);
+
 signals:
   void PrintingFinished();
 
@@ -76,37 +79,55 @@ private slots:
    * instance
    */
   void DisplayMessageBox(QString *argErrorMessage, QString *argHeading);
-  /*! Prints the receipts
+  /*! Indexes newly created payment files and awaits their completion
    */
-  void PrintReceipts();
+  void GotPaymentFileChanged();
+  /*! Queues all completely written payment files for printing
+   */
+  void CheckPendingPaymentFiles();
 
 private:
-  void CreateReceiptsFromPaymentFile();
-  QVector<QString> *GetParticipantsDataFromPaymentFile();
-  QString *LoadLatexHeader();
-  void MakeReceiptsAnonymous(QVector<paymentEntry_t *> *argDataVector,
-                             bool argAlsoAnonymizeClients);
+  bool CreateReceiptsFromPaymentFile();
+  bool CreateReceiptsNatively(const QString &argTemplatePath,
+                              const receiptsSection_t &argSection);
+  static bool IsPaymentFileComplete(const QString &argPath,
+                                    qint64 &argLastSize);
+  /*! Prints the receipts of the next queued payment file
+   */
+  void PrintNextPaymentFile();
+  void StartReceiptsPrinter(bool argRenderedNatively,
+                            const QString &argLaTeXHeaderPath);
+  static void MakeReceiptsAnonymous(QVector<paymentEntry_t> &argDataVector,
+                                    const QString &argPlaceholder,
+                                    bool argAlsoAnonymizeClients);
 
   const QString
       anonymousReceiptsPlaceholder; //!< Placeholder which shall be inserted for
                                     //!< participant names if anonymous printing
                                     //!< is desired (QString != "")
-  const QString dateString; //!< The expected date string of the payment file in
-                            //!< form 'yyMMdd_hhmm'
-  const QString
-      expectedPaymentFileName; //!< The name of the expected payment file
-  const QString
-      expectedPaymentFilePath; //!< The path of the expected payment file
+  QString dateString; //!< The date string of the payment file being printed
+                      //!< in form 'yyMMdd_hhmm'
   const QString
       latexHeaderName; //!< The name of the chosen LaTeX header template
-  QFile paymentFile;   //!< A pointer to the '*.pay' file being watched for
-                       //!< existance and starting the printing process
+  QString paymentFilePath; //!< The path of the payment file being printed
+  QHash<QString, qint64>
+      pendingPaymentFiles; //!< The payment files still being written with
+                           //!< their sizes at the last completeness check
+  QSet<QString> processedPaymentFiles; //!< The payment files which were
+                                       //!< already queued for printing
+  QStringList queuedPaymentFiles; //!< Complete payment files awaiting printing
   const bool printReceiptsForLocalClients; //!< Stores if receipts shall be
                                            //!< printed for local clients
+  const ReceiptsScheduler::Priority
+      priority; //!< The priority of the receipts jobs at the lab's scheduler
+  bool receiptsPrinted = false; //!< Set once the receipts of the payment file
+                                //!< being printed reached the printer
   ReceiptsPrinter *receiptsPrinter =
-      nullptr; //!< Creates new thread for receipts printing
-  QTimer *timer =
-      nullptr; //!< Used for regular checking if the payment file was created
+      nullptr; //!< Runs the receipts job of the payment file being printed
+  QTimer *settleTimer = nullptr; //!< Delays the completeness checks until the
+                                 //!< payment files were left untouched
+  QFileSystemWatcher *watcher =
+      nullptr; //!< Watches for the creation of and writes to payment files
   const QString zTreeDataTargetPath; //!< A reference to the data target path
                                      //!< stored in the session class instance
 };
@@ -0,0 +1,232 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QTextStream>
+#include <QtConcurrent>
+
+#include "receipts_handler.h"
+#include "receiptsbatch.h"
+#include "receiptsprinter.h"
+#include "receiptsscheduler.h"
+
+extern std::unique_ptr<lc::ReceiptsScheduler> receiptsScheduler;
+
+lc::ReceiptsBatch::ReceiptsBatch(const QString &argDirectory,
+                                 const bool argPrintReceiptsForLocalClients,
+                                 const QString &argAnonymousReceiptsPlaceholder,
+                                 const QString &argTemplateName,
+                                 const Grouping argGrouping,
+                                 QObject *argParent)
+    : QObject{argParent},
+      anonymousReceiptsPlaceholder{argAnonymousReceiptsPlaceholder},
+      directory{argDirectory}, grouping{argGrouping},
+      printReceiptsForLocalClients{argPrintReceiptsForLocalClients},
+      templateName{argTemplateName} {}
+
+/*!
+ * \brief Find all payment files below the directory and group them
+ *
+ * \return The sorted paths of the payment files keyed by their group's name
+ */
+QMap<QString, QStringList> lc::ReceiptsBatch::FindPaymentFiles() const {
+  QMap<QString, QStringList> groups;
+  QDirIterator it{directory, QStringList{"*.pay"}, QDir::Files,
+                  QDirIterator::Subdirectories};
+  while (it.hasNext()) {
+    const QFileInfo info{it.next()};
+    QString group;
+    if (grouping == Grouping::PER_DAY) {
+      // z-Tree names the payment files 'yyMMdd_hhmm.pay'
+      bool isDate = false;
+      info.completeBaseName().left(6).toUInt(&isDate);
+      group = isDate && info.completeBaseName().size() >= 6
+                  ? info.completeBaseName().left(6)
+                  : info.lastModified().toString("yyMMdd");
+    } else {
+      group = QDir{directory}.relativeFilePath(info.path());
+      group = group == "." ? QDir{directory}.dirName()
+                           : group.replace('/', '_');
+    }
+    groups[group].append(info.filePath());
+  }
+  for (auto &paymentFiles : groups) {
+    paymentFiles.sort();
+  }
+  return groups;
+}
+
+void lc::ReceiptsBatch::FinishGroup(const QString &argPDFPath,
+                                    const bool argSucceeded) {
+  if (argSucceeded) {
+    createdFiles.append(argPDFPath);
+  } else {
+    failedFiles.append(argPDFPath);
+  }
+  if (--pendingGroups == 0) {
+    qDebug() << "Batch reprint created" << createdFiles.size()
+             << "PDF files, failed for" << failedFiles;
+    emit Finished(createdFiles, failedFiles);
+  }
+}
+
+/*!
+ * \brief Compile the group's LaTeX document if needed
+ *
+ * \param[in] argBaseName The name of the group's files without suffix
+ * \param[in] argPrepared If the group's PDF file (or TeX file respectively)
+ * was written
+ */
+void lc::ReceiptsBatch::GotGroupPrepared(const QString &argBaseName,
+                                         const bool argPrepared) {
+  const QString pdfPath{directory + "/" + argBaseName + ".pdf"};
+  if (!argPrepared || latexHeaderPath.isEmpty()) {
+    FinishGroup(pdfPath, argPrepared);
+    return;
+  }
+
+  ReceiptsPrinter *const printer{new ReceiptsPrinter{
+      argBaseName, directory, false, latexHeaderPath, this}};
+  printer->SetOnlyCreatePDF(true);
+  connect(printer, &ReceiptsPrinter::PrintingFinished, this,
+          [this, printer, pdfPath]() {
+            printer->deleteLater();
+            FinishGroup(pdfPath, QFile::exists(pdfPath));
+          });
+  // A batch shall not flood the screen with message boxes
+  connect(printer, &ReceiptsPrinter::ErrorOccurred, this,
+          [pdfPath](QString *argErrorMessage, QString *argHeading) {
+            qWarning().noquote() << pdfPath << "-" << *argHeading << "-"
+                                 << *argErrorMessage;
+            delete argErrorMessage;
+            delete argHeading;
+          });
+  receiptsScheduler->Submit(printer, ReceiptsScheduler::Priority::NORMAL);
+}
+
+/*!
+ * \brief Merge the receipts of a group's payment files into one document
+ *
+ * This runs in the global thread pool and must not touch the batch.
+ *
+ * \param[in] argPaymentFiles The group's payment files
+ * \param[in] argBasePath The path of the group's files without suffix
+ * \param[in] argPrintReceiptsForLocalClients If receipts shall be created for
+ * local clients
+ * \param[in] argAnonymousReceiptsPlaceholder Placeholder replacing the
+ * participants' names (empty if the receipts shall not be anonymous)
+ * \param[in] argRenderer The native renderer (nullptr if LaTeX is used)
+ * \param[in] argTemplate The LaTeX template (nullptr if rendered natively)
+ *
+ * \return True, if the PDF file (or the TeX file) was written
+ */
+bool lc::ReceiptsBatch::PrepareGroup(
+    const QStringList &argPaymentFiles, const QString &argBasePath,
+    const bool argPrintReceiptsForLocalClients,
+    const QString &argAnonymousReceiptsPlaceholder,
+    const std::shared_ptr<const PdfReceiptsRenderer> &argRenderer,
+    const std::shared_ptr<const LaTeXReceiptsTemplate> &argTemplate) {
+  QVector<receiptsSection_t> sections;
+  sections.reserve(argPaymentFiles.size());
+  for (const auto &paymentFile : argPaymentFiles) {
+    receiptsSection_t section;
+    if (ReceiptsHandler::CreateReceiptsSection(
+            paymentFile, argPrintReceiptsForLocalClients,
+            argAnonymousReceiptsPlaceholder, section) &&
+        !section.overview.isEmpty()) {
+      sections.append(section);
+    }
+  }
+  // Never report an outdated PDF file of an earlier run as created
+  QFile::remove(argBasePath + ".pdf");
+  if (sections.isEmpty()) {
+    return false;
+  }
+
+  if (argRenderer) {
+    return argRenderer->Render(argBasePath + ".pdf", sections);
+  }
+  QFile texFile{argBasePath + ".tex"};
+  if (!texFile.open(QIODevice::Text | QIODevice::WriteOnly)) {
+    return false;
+  }
+  QTextStream out{&texFile};
+  out << argTemplate->Build(sections);
+  out.flush();
+  return out.status() == QTextStream::Ok;
+}
+
+/*!
+ * \brief Start creating the PDF files
+ *
+ * Finished() is emitted once all of them were processed.
+ */
+void lc::ReceiptsBatch::Start() {
+  const QMap<QString, QStringList> groups{FindPaymentFiles()};
+  qDebug() << "Batch reprint of" << groups.size() << "groups of payment files"
+           << "in" << directory;
+
+  // The template is loaded once here, since the workers only read it
+  std::shared_ptr<const PdfReceiptsRenderer> renderer;
+  std::shared_ptr<const LaTeXReceiptsTemplate> latexTemplate;
+  const QString templatePath{
+      PdfReceiptsRenderer::GetTemplatePath(templateName)};
+  if (QFile::exists(templatePath)) {
+    renderer = std::make_shared<const PdfReceiptsRenderer>(templatePath);
+    if (!renderer->IsValid()) {
+      qWarning() << renderer->GetError();
+      renderer.reset();
+    }
+  } else {
+    latexHeaderPath = LaTeXReceiptsTemplate::GetHeaderPath(templateName);
+    latexTemplate = LaTeXReceiptsTemplate::Load(latexHeaderPath);
+  }
+
+  pendingGroups = groups.size();
+  if (groups.isEmpty()) {
+    emit Finished(createdFiles, failedFiles);
+    return;
+  }
+  for (auto it = groups.constBegin(); it != groups.constEnd(); ++it) {
+    const QString baseName{"receipts_" + it.key()};
+    if (!renderer && !latexTemplate) {
+      FinishGroup(directory + "/" + baseName + ".pdf", false);
+      continue;
+    }
+    QFutureWatcher<bool> *const watcher{new QFutureWatcher<bool>{this}};
+    connect(watcher, &QFutureWatcher<bool>::finished, this,
+            [this, watcher, baseName]() {
+              watcher->deleteLater();
+              GotGroupPrepared(baseName, watcher->result());
+            });
+    const QStringList paymentFiles{it.value()};
+    const QString basePath{directory + "/" + baseName};
+    const bool printForLocalClients{printReceiptsForLocalClients};
+    const QString placeholder{anonymousReceiptsPlaceholder};
+    watcher->setFuture(QtConcurrent::run([=]() {
+      return PrepareGroup(paymentFiles, basePath, printForLocalClients,
+                          placeholder, renderer, latexTemplate);
+    }));
+  }
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RECEIPTSBATCH_H
+#define RECEIPTSBATCH_H
+
+#include <memory>
+
+#include <QMap>
+#include <QObject>
+#include <QStringList>
+
+#include "latexreceiptstemplate.h"
+#include "paymentfile.h"
+#include "pdfreceiptsrenderer.h"
+
+namespace lc {
+
+/*!
+ * \brief Re-renders all payment files of a directory tree into merged PDFs
+ *
+ * The payment files are grouped per day (by the date in their names) or per
+ * session (by the directory they are stored in). Every group is merged into
+ * a single PDF file named 'receipts_<group>.pdf' in the chosen directory.
+ * The payment files are read and rendered in the global thread pool. LaTeX
+ * documents are then compiled by the lab's ReceiptsScheduler after the jobs
+ * of running sessions. Nothing is printed.
+ */
+class ReceiptsBatch : public QObject {
+  Q_OBJECT
+
+public:
+  //! The way the payment files are merged into PDF files
+  enum class Grouping {
+    //! One PDF file per day
+    PER_DAY,
+    //! One PDF file per directory containing payment files
+    PER_SESSION
+  };
+
+  explicit ReceiptsBatch(const QString &argDirectory,
+                         bool argPrintReceiptsForLocalClients,
+                         const QString &argAnonymousReceiptsPlaceholder,
+                         const QString &argTemplateName, Grouping argGrouping,
+                         QObject *argParent = nullptr);
+
+  void Start();
+
+signals:
+  /*!
+   * \brief Emitted once all groups were processed
+   *
+   * \param argCreatedFiles The PDF files which were created
+   * \param argFailedFiles The PDF files which could not be created
+   */
+  void Finished(const QStringList &argCreatedFiles,
+                const QStringList &argFailedFiles);
+
+private:
+  QMap<QString, QStringList> FindPaymentFiles() const;
+  void FinishGroup(const QString &argPDFPath, bool argSucceeded);
+  void GotGroupPrepared(const QString &argBaseName, bool argPrepared);
+  static bool
+  PrepareGroup(const QStringList &argPaymentFiles, const QString &argBasePath,
+               bool argPrintReceiptsForLocalClients,
+               const QString &argAnonymousReceiptsPlaceholder,
+               const std::shared_ptr<const PdfReceiptsRenderer> &argRenderer,
+               const std::shared_ptr<const LaTeXReceiptsTemplate> &argTemplate);
+
+  //! Placeholder replacing the participants' names (empty if not anonymous)
+  const QString anonymousReceiptsPlaceholder;
+  //! The PDF files which were created
+  QStringList createdFiles;
+  //! The root of the directory tree containing the payment files
+  const QString directory;
+  //! The PDF files which could not be created
+  QStringList failedFiles;
+  const Grouping grouping;
+  //! The LaTeX header of the template (empty if it is rendered natively)
+  QString latexHeaderPath;
+  //! The number of groups whose PDF files are not yet created
+  int pendingGroups = 0;
+  //! Stores if receipts shall be created for local clients
+  const bool printReceiptsForLocalClients;
+  //! The name of the chosen receipts template
+  const QString templateName;
+};
+
+} // namespace lc
+
+#endif // RECEIPTSBATCH_H
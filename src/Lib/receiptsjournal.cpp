@@ -0,0 +1,247 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include "receiptsjournal.h"
+
+namespace {
+const QStringList stateNames{QStringList{} << "detected"
+                                           << "rendered"
+                                           << "printed"
+                                           << "archived"
+                                           << "failed"};
+//! The number of failures after which a job is not resumed anymore
+const int maxFailures = 3;
+
+//! Returns the fields of the line recording a newly queued job
+QStringList GetDetectedFields(const lc::ReceiptsJournal::Job &argJob) {
+  return QStringList{} << stateNames.at(static_cast<int>(
+                              lc::ReceiptsJournal::State::DETECTED))
+                       << argJob.paymentFilePath << argJob.templateName
+                       << (argJob.receiptsForLocalClients ? "1" : "0")
+                       << argJob.anonymousReceiptsPlaceholder;
+}
+
+//! Keeps the journal's field and line separators out of free texts
+QString Sanitize(QString argText) {
+  return argText.replace('\t', ' ').replace('\n', ' ');
+}
+
+//! Writes a time stamped line with the given fields
+void WriteLine(QTextStream &argOut, const QStringList &argFields) {
+  argOut << QDateTime::currentDateTime().toString(Qt::ISODate) << '\t'
+         << argFields.join('\t') << '\n';
+}
+} // namespace
+
+/*!
+ * \brief Open the journal at the given path, reading the recorded jobs
+ *
+ * \param[in] argPath The path of the journal file (created if missing)
+ */
+lc::ReceiptsJournal::ReceiptsJournal(const QString &argPath) : path{argPath} {
+  QDir{}.mkpath(QFileInfo{path}.path());
+  Read();
+  Compact();
+}
+
+/*!
+ * \brief Append a line and flush it to disk
+ *
+ * \param[in] argFields The line's fields following the time stamp
+ */
+void lc::ReceiptsJournal::Append(const QStringList &argFields) {
+  QFile journalFile{path};
+  if (!journalFile.open(QIODevice::Append | QIODevice::Text)) {
+    qWarning() << "The receipts journal" << path << "could not be written";
+    return;
+  }
+  QTextStream out{&journalFile};
+  WriteLine(out, argFields);
+  out.flush();
+  journalFile.flush();
+}
+
+/*!
+ * \brief Rewrite the journal with only the jobs which were not archived
+ *
+ * The journal is replaced atomically, so that a crash leaves either the old or
+ * the compacted journal behind.
+ */
+void lc::ReceiptsJournal::Compact() {
+  for (auto it = jobs.begin(); it != jobs.end();) {
+    if (it->state == State::ARCHIVED) {
+      it = jobs.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  QSaveFile journalFile{path};
+  if (!journalFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    qWarning() << "The receipts journal" << path << "could not be compacted";
+    return;
+  }
+  QTextStream out{&journalFile};
+  for (const auto &job : jobs) {
+    WriteLine(out, GetDetectedFields(job));
+    // Every failure has its own line, so that the failures are counted again
+    for (int i = 0; i < job.failures; ++i) {
+      WriteLine(out, QStringList{}
+                         << stateNames.at(static_cast<int>(State::FAILED))
+                         << job.paymentFilePath);
+    }
+    if (job.state != State::DETECTED && job.state != State::FAILED) {
+      WriteLine(out, QStringList{} << stateNames.at(static_cast<int>(job.state))
+                                   << job.paymentFilePath);
+    }
+  }
+  out.flush();
+  if (!journalFile.commit()) {
+    qWarning() << "The receipts journal" << path << "could not be compacted";
+  }
+}
+
+/*!
+ * \brief Check if the job of the given payment file finished
+ *
+ * \param[in] argPaymentFilePath The path of the payment file
+ */
+bool lc::ReceiptsJournal::IsFinished(const QString &argPaymentFilePath) const {
+  const auto job = jobs.constFind(argPaymentFilePath);
+  return job != jobs.constEnd() && job->state == State::ARCHIVED;
+}
+
+void lc::ReceiptsJournal::Read() {
+  QFile journalFile{path};
+  if (!journalFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    return;
+  }
+  QTextStream in{&journalFile};
+  while (!in.atEnd()) {
+    const QStringList fields{in.readLine().split('\t')};
+    // Lines cut off by a crash are skipped
+    const int state = fields.size() >= 3 ? stateNames.indexOf(fields[1]) : -1;
+    if (state < 0) {
+      continue;
+    }
+    if (static_cast<State>(state) == State::DETECTED) {
+      if (fields.size() != 6) {
+        continue;
+      }
+      Job &job = jobs[fields[2]];
+      job.paymentFilePath = fields[2];
+      job.templateName = fields[3];
+      job.receiptsForLocalClients = fields[4] == "1";
+      job.anonymousReceiptsPlaceholder = fields[5];
+      job.state = State::DETECTED;
+    } else if (jobs.contains(fields[2])) {
+      Job &job = jobs[fields[2]];
+      job.state = static_cast<State>(state);
+      if (job.state == State::FAILED) {
+        ++job.failures;
+      }
+    }
+  }
+}
+
+/*!
+ * \brief Record that a job reached the given state
+ *
+ * \param[in] argPaymentFilePath The path of the job's payment file
+ * \param[in] argState The reached state
+ */
+void lc::ReceiptsJournal::Record(const QString &argPaymentFilePath,
+                                 const State argState) {
+  const auto job = jobs.find(argPaymentFilePath);
+  if (job == jobs.end()) {
+    return;
+  }
+  job->state = argState;
+  if (argState == State::FAILED) {
+    ++job->failures;
+  }
+  Append(QStringList{} << stateNames.at(static_cast<int>(argState))
+                       << argPaymentFilePath);
+}
+
+/*!
+ * \brief Record a newly queued job with all its parameters
+ *
+ * \param[in] argPaymentFilePath The path of the job's payment file
+ * \param[in] argTemplateName The name of the receipts template
+ * \param[in] argReceiptsForLocalClients If receipts are created for local
+ * clients
+ * \param[in] argAnonymousReceiptsPlaceholder The placeholder replacing the
+ * participants' names (empty if the receipts are not anonymous)
+ */
+void lc::ReceiptsJournal::RecordDetected(
+    const QString &argPaymentFilePath, const QString &argTemplateName,
+    const bool argReceiptsForLocalClients,
+    const QString &argAnonymousReceiptsPlaceholder) {
+  Job job;
+  job.paymentFilePath = argPaymentFilePath;
+  job.templateName = Sanitize(argTemplateName);
+  job.receiptsForLocalClients = argReceiptsForLocalClients;
+  job.anonymousReceiptsPlaceholder = Sanitize(argAnonymousReceiptsPlaceholder);
+  job.state = State::DETECTED;
+  // Resumed jobs keep counting their failures
+  job.failures = jobs.value(argPaymentFilePath).failures;
+  jobs.insert(argPaymentFilePath, job);
+  Append(GetDetectedFields(job));
+}
+
+/*!
+ * \brief Return the jobs which did not finish and must be run again
+ *
+ * Jobs whose receipts were already printed or whose payment files vanished
+ * are recorded as finished instead, so that nothing gets printed twice. Failed
+ * jobs are run again, unless they failed too often already.
+ *
+ * \return The jobs which shall be run again
+ */
+QVector<lc::ReceiptsJournal::Job> lc::ReceiptsJournal::TakeJobsToResume() {
+  QVector<Job> jobsToResume;
+  // Copied, since recording a state modifies the jobs
+  const QHash<QString, Job> recordedJobs{jobs};
+  for (const auto &job : recordedJobs) {
+    if (job.state == State::ARCHIVED) {
+      continue;
+    }
+    if (job.state == State::PRINTED ||
+        !QFile::exists(job.paymentFilePath)) {
+      qDebug() << "Not resuming the receipts job of" << job.paymentFilePath;
+      Record(job.paymentFilePath, State::ARCHIVED);
+    } else if (job.failures >= maxFailures) {
+      qWarning() << "Giving up the receipts job of" << job.paymentFilePath
+                 << "after" << job.failures << "failures";
+      Record(job.paymentFilePath, State::ARCHIVED);
+    } else {
+      jobsToResume.append(job);
+    }
+  }
+  return jobsToResume;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RECEIPTSJOURNAL_H
+#define RECEIPTSJOURNAL_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace lc {
+
+/*!
+ * \brief An append-only on-disk journal of the receipts jobs
+ *
+ * Every job is identified by its payment file. A line is appended and
+ * flushed whenever a job reaches its next state, so that the journal
+ * survives crashes. On startup the journal is read to resume the jobs which
+ * did not finish and rewritten without the archived ones, so that it does
+ * not grow endlessly. Jobs whose receipts were already printed are not
+ * printed again, failed jobs are retried on a limited number of starts.
+ */
+class ReceiptsJournal {
+public:
+  //! The states a receipts job passes
+  enum class State {
+    //! The payment file was complete and the job was queued
+    DETECTED,
+    //! The receipts were rendered and handed over for printing
+    RENDERED,
+    //! The receipts were passed to the printer
+    PRINTED,
+    //! The receipts were printed and the job finished
+    ARCHIVED,
+    //! Rendering or printing failed, the job is run again on the next start
+    //! unless it failed too often
+    FAILED
+  };
+  //! A receipts job as recorded in the journal
+  struct Job {
+    QString paymentFilePath;
+    QString templateName;
+    bool receiptsForLocalClients;
+    QString anonymousReceiptsPlaceholder;
+    State state;
+    //! The number of times the job failed
+    int failures = 0;
+  };
+
+  explicit ReceiptsJournal(const QString &argPath);
+
+  bool IsFinished(const QString &argPaymentFilePath) const;
+  void Record(const QString &argPaymentFilePath, State argState);
+  void RecordDetected(const QString &argPaymentFilePath,
+                      const QString &argTemplateName,
+                      bool argReceiptsForLocalClients,
+                      const QString &argAnonymousReceiptsPlaceholder);
+  QVector<Job> TakeJobsToResume();
+
+private:
+  void Append(const QStringList &argFields);
+  void Compact();
+  void Read();
+
+  //! The latest state of every job keyed by its payment file
+  QHash<QString, Job> jobs;
+  //! The path of the journal file
+  const QString path;
+};
+
+} // namespace lc
+
+#endif // RECEIPTSJOURNAL_H
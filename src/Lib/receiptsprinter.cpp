@@ -19,16 +19,329 @@
 
 #include <memory>
 
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QTimer>
+
 #include "receiptsprinter.h"
+#include "receiptsscheduler.h"
 #include "settings.h"
 
+extern std::unique_ptr<lc::ReceiptsScheduler> receiptsScheduler;
 extern std::unique_ptr<lc::Settings> settings;
 
 lc::ReceiptsPrinter::ReceiptsPrinter(const QString &argDateString,
                                      const QString &argWorkpath,
+                                     const bool argRenderedNatively,
+                                     const QString &argLaTeXHeaderPath,
                                      QObject *argParent)
-    : QThread{argParent}, dateString{argDateString},
-      dvipsCmd{settings->dvipsCmd}, latexCmd{settings->latexCmd},
+    : QObject{argParent}, dateString{argDateString},
+      dvipsCmd{settings->dvipsCmd}, formatCache{argLaTeXHeaderPath},
+      latexCmd{settings->latexCmd}, laTeXHeaderPath{argLaTeXHeaderPath},
       lprCmd{settings->lprCmd}, postscriptViewer{settings->postscriptViewer},
-      ps2pdfCmd{settings->ps2pdfCmd}, rmCmd{settings->rmCmd},
-      vncViewer{settings->vncViewer}, workpath{argWorkpath} {}
+      ps2pdfCmd{settings->ps2pdfCmd}, renderedNatively{argRenderedNatively},
+      rmCmd{settings->rmCmd}, vncViewer{settings->vncViewer},
+      workpath{argWorkpath} {}
+
+/*!
+ * \brief Remove the temporary files of the LaTeX compilation
+ */
+void lc::ReceiptsPrinter::CleanUp() {
+  if (!settings->IsPathAvailable(rmCmd)) {
+    Finish();
+    return;
+  }
+  QStringList files{QStringList{}
+                    << QString{workpath + "/" + dateString + ".aux"}
+                    << QString{workpath + "/" + dateString + ".dvi"}
+                    << QString{workpath + "/" + dateString + ".log"}
+                    << QString{workpath + "/" + dateString + ".tex"}};
+  // The postscript file is only kept as printed document
+  if (onlyCreatePDF) {
+    files << QString{workpath + "/" + dateString + ".ps"};
+  }
+  RunStage(Stage::CLEAN_UP, rmCmd, files, processTimeOut,
+           QProcessEnvironment::systemEnvironment());
+}
+
+/*!
+ * \brief Compile the TeX file to dvi
+ *
+ * \param[in] argUseFormat If the header's precompiled format shall be used
+ */
+void lc::ReceiptsPrinter::Compile(const bool argUseFormat) {
+  QStringList arguments;
+  arguments << "-interaction"
+            << "batchmode";
+  QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+  if (argUseFormat) {
+    arguments << formatCache.GetCompileArguments();
+    env = formatCache.GetEnvironment(env);
+  }
+  arguments << QString{dateString + ".tex"};
+  RunStage(Stage::COMPILE, latexCmd, arguments, processTimeOut, env);
+}
+
+void lc::ReceiptsPrinter::Finish() {
+  qDebug().noquote() << "Receipts stage timings:" << stageTimings.join(", ");
+  emit PrintingFinished();
+}
+
+QString lc::ReceiptsPrinter::GetStageName(const Stage argStage) {
+  switch (argStage) {
+  case Stage::BUILD_FORMAT:
+    return "format building";
+  case Stage::COMPILE:
+    return "compilation";
+  case Stage::CONVERT_TO_POSTSCRIPT:
+    return "postscript conversion";
+  case Stage::CONVERT_TO_PDF:
+    return "PDF conversion";
+  case Stage::CLEAN_UP:
+    return "cleanup";
+  }
+  return QString{};
+}
+
+/*!
+ * \brief Record a finished stage and start the stages depending on it
+ *
+ * \param[in] argStage The finished stage
+ * \param[in] argProcess The process which ran the stage
+ */
+void lc::ReceiptsPrinter::GotStageFinished(const Stage argStage,
+                                           QProcess *const argProcess) {
+  // Processes failing to start report an error and may report finishing, too
+  if (!running.contains(argProcess)) {
+    return;
+  }
+  const qint64 duration = clock.elapsed() - running.take(argProcess);
+  argProcess->deleteLater();
+  const bool succeeded = argProcess->error() != QProcess::FailedToStart &&
+                         argProcess->exitStatus() == QProcess::NormalExit &&
+                         argProcess->exitCode() == 0;
+  stageTimings.append(QString{"%1 %2 ms%3"}
+                          .arg(GetStageName(argStage))
+                          .arg(duration)
+                          .arg(succeeded ? "" : " (failed)"));
+
+  switch (argStage) {
+  case Stage::BUILD_FORMAT:
+    formatCache.SetBuilding(false);
+    if (!succeeded || !formatCache.IsUpToDate()) {
+      qWarning() << "The LaTeX format of" << laTeXHeaderPath
+                 << "could not be built, is 'mylatexformat' installed?";
+    }
+    Compile(formatCache.IsUpToDate());
+    break;
+  case Stage::COMPILE:
+    // 'latex' in batch mode may report errors while still creating the dvi
+    if (!QFile::exists(workpath + "/" + dateString + ".dvi")) {
+      ReportError("dvi creation failed",
+                  "The creation of the receipts dvi failed. Automatic "
+                  "receipts creation will not work.");
+      Finish();
+      break;
+    }
+    RunStage(Stage::CONVERT_TO_POSTSCRIPT, dvipsCmd,
+             QStringList{} << "-q*"
+                           << "-o" << QString{dateString + ".ps"}
+                           << QString{dateString + ".dvi"},
+             processTimeOut, QProcessEnvironment::systemEnvironment());
+    break;
+  case Stage::CONVERT_TO_POSTSCRIPT:
+    if (!succeeded) {
+      ReportError("dvi to postscript conversion failed",
+                  "The conversion of the receipts dvi to postscript failed. "
+                  "Automatic receipts creation will not work.");
+      Finish();
+      break;
+    }
+    // Printing and the PDF conversion only read the postscript file
+    if (!onlyCreatePDF && settings->IsPathAvailable(lprCmd)) {
+      RequestPrint(workpath + "/" + dateString + ".ps");
+    }
+    if (settings->IsPathAvailable(ps2pdfCmd)) {
+      RunStage(Stage::CONVERT_TO_PDF, ps2pdfCmd,
+               QStringList{} << QString{workpath + "/" + dateString + ".ps"}
+                             << QString{workpath + "/" + dateString + ".pdf"},
+               processTimeOut, QProcessEnvironment::systemEnvironment());
+    }
+    break;
+  case Stage::CONVERT_TO_PDF:
+    if (!succeeded) {
+      ReportError("PDF creation failed",
+                  "The conversion of the receipts postscript file to PDF "
+                  "failed.");
+    }
+    if (!onlyCreatePDF && settings->IsPathAvailable(postscriptViewer)) {
+      QProcess::startDetached(
+          postscriptViewer,
+          QStringList{workpath + "/" + dateString + ".ps"}, workpath);
+    }
+    break;
+  case Stage::CLEAN_UP:
+    if (!succeeded) {
+      ReportError("Cleanup failed",
+                  "The cleanup of the temporary files for receipts creation "
+                  "failed. Some spare files may be left in your zTree "
+                  "working directory.");
+    }
+    Finish();
+    return;
+  }
+
+  if (argStage == Stage::CONVERT_TO_PDF ||
+      (argStage == Stage::CONVERT_TO_POSTSCRIPT && succeeded)) {
+    FinishIfIdle();
+  }
+}
+
+/*!
+ * \brief Clean up once printing and the PDF conversion both finished
+ */
+void lc::ReceiptsPrinter::FinishIfIdle() {
+  if (!running.isEmpty() || !printedFile.isEmpty()) {
+    return;
+  }
+  if (renderedNatively) {
+    Finish();
+  } else {
+    CleanUp();
+  }
+}
+
+/*!
+ * \brief Record the end of printing if the printed files contain this job's
+ * file
+ *
+ * \param[in] argFiles The files printed by the finished 'lpr' run
+ * \param[in] argSucceeded If the files were printed successfully
+ */
+void lc::ReceiptsPrinter::GotPrintJobsFinished(const QStringList &argFiles,
+                                               const bool argSucceeded) {
+  if (printedFile.isEmpty() || !argFiles.contains(printedFile)) {
+    return;
+  }
+  printedFile.clear();
+  stageTimings.append(QString{"printing %1 ms%2"}
+                          .arg(clock.elapsed() - printStart)
+                          .arg(argSucceeded ? "" : " (failed)"));
+  if (argSucceeded) {
+    emit Printed();
+  } else {
+    ReportError("Printing failed",
+                QString{"The receipts %1 file was successfully created but "
+                        "could not be printed."}
+                    .arg(renderedNatively ? "PDF" : "postscript"));
+  }
+  FinishIfIdle();
+}
+
+void lc::ReceiptsPrinter::ReportError(const QString &argHeading,
+                                      const QString &argMessage) {
+  emit ErrorOccurred(new QString{argMessage}, new QString{argHeading});
+}
+
+/*!
+ * \brief Let the lab's receipts scheduler print the given file
+ *
+ * Printing is merged with the print requests of other sessions.
+ *
+ * \param[in] argFile The file which shall be printed
+ */
+void lc::ReceiptsPrinter::RequestPrint(const QString &argFile) {
+  printedFile = argFile;
+  printStart = clock.elapsed();
+  connect(receiptsScheduler.get(), &ReceiptsScheduler::PrintJobsFinished, this,
+          &ReceiptsPrinter::GotPrintJobsFinished, Qt::UniqueConnection);
+  receiptsScheduler->Print(argFile);
+}
+
+/*!
+ * \brief Start a stage's process without waiting for it
+ *
+ * \param[in] argStage The stage to be started
+ * \param[in] argProgram The program running the stage
+ * \param[in] argArguments The arguments passed to the program
+ * \param[in] argTimeout The time in milliseconds after which it gets killed
+ * \param[in] argEnvironment The environment the program runs in
+ */
+void lc::ReceiptsPrinter::RunStage(const Stage argStage,
+                                   const QString &argProgram,
+                                   const QStringList &argArguments,
+                                   const int argTimeout,
+                                   const QProcessEnvironment &argEnvironment) {
+  QProcess *const process = new QProcess{this};
+  running.insert(process, clock.elapsed());
+  connect(process,
+          static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(
+              &QProcess::finished),
+          this, [this, argStage, process]() {
+            GotStageFinished(argStage, process);
+          });
+  // Queued, since start() may report the failure before parallel stages ran
+  connect(
+      process, &QProcess::errorOccurred, this,
+      [this, argStage, process](const QProcess::ProcessError argError) {
+        if (argError == QProcess::FailedToStart) {
+          GotStageFinished(argStage, process);
+        }
+      },
+      Qt::QueuedConnection);
+  QTimer::singleShot(argTimeout, process, [process]() { process->kill(); });
+
+  process->setProcessEnvironment(argEnvironment);
+  process->setWorkingDirectory(argStage == Stage::BUILD_FORMAT
+                                   ? formatCache.GetFormatDirectory()
+                                   : workpath);
+  process->start(argProgram, argArguments);
+}
+
+/*!
+ * \brief Start the pipeline
+ */
+void lc::ReceiptsPrinter::Start() {
+  clock.start();
+
+  // Natively rendered receipts only need to be printed and shown
+  if (renderedNatively && onlyCreatePDF) {
+    Finish();
+    return;
+  }
+  if (renderedNatively) {
+    const QString pdfPath{workpath + "/" + dateString + ".pdf"};
+    if (settings->IsPathAvailable(postscriptViewer)) {
+      QProcess::startDetached(postscriptViewer, QStringList{pdfPath},
+                              workpath);
+    }
+    if (!settings->IsPathAvailable(lprCmd)) {
+      Finish();
+      return;
+    }
+    RequestPrint(pdfPath);
+    return;
+  }
+
+  // The format cannot be used while another job is writing it
+  if (!laTeXHeaderPath.isEmpty() && formatCache.IsBeingBuilt()) {
+    Compile(false);
+    return;
+  }
+  // Build the header's format first if it is missing or outdated
+  if (laTeXHeaderPath.isEmpty() || formatCache.IsUpToDate()) {
+    Compile(!laTeXHeaderPath.isEmpty());
+    return;
+  }
+  if (!QDir{}.mkpath(formatCache.GetFormatDirectory())) {
+    qWarning() << "The directory" << formatCache.GetFormatDirectory()
+               << "for the LaTeX formats could not be created";
+    Compile(false);
+    return;
+  }
+  qDebug() << "Building the LaTeX format of" << laTeXHeaderPath;
+  formatCache.SetBuilding(true);
+  RunStage(Stage::BUILD_FORMAT, latexCmd, formatCache.GetBuildArguments(),
+           4 * processTimeOut, QProcessEnvironment::systemEnvironment());
+}
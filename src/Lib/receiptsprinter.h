@@ -20,165 +20,104 @@
 #ifndef RECEIPTSPRINTER_H
 #define RECEIPTSPRINTER_H
 
-#include <QMessageBox>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QProcess>
-#include <QThread>
+#include <QStringList>
+
+#include "latexformatcache.h"
 
 namespace lc {
 
 //! A class for receipts creation.
 /*!
-  This class is used to do the actual printing of the receipts in an own thread.
+  This class runs the external programs creating, printing and showing the
+  receipts as an asynchronous stage graph: the TeX file is compiled to dvi
+  (after building the header's format if needed) and converted to
+  postscript, which is then printed and converted to PDF in parallel. The
+  viewer is started after the conversion and the temporary files are removed
+  once all stages finished. No thread blocks waiting for a process and the
+  duration of every stage is reported. The lab's ReceiptsScheduler starts the
+  pipeline and does the printing, merged with that of other sessions.
 */
-class ReceiptsPrinter : public QThread {
+class ReceiptsPrinter : public QObject {
   Q_OBJECT
 
-  void run() Q_DECL_OVERRIDE {
-    // Compile the TeX file to dvi
-    QStringList arguments;
-    arguments << "-interaction"
-              << "batchmode" << QString{dateString + ".tex"};
-
-    QProcess *process = nullptr;
-    process = new QProcess{};
-    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-    process->setProcessEnvironment(env);
-    process->setWorkingDirectory(workpath);
-    process->start(latexCmd, arguments);
-    if (!process->waitForFinished(processTimeOut)) {
-      QMessageBox message_box{
-          QMessageBox::Warning, "dvi creation failed",
-          "The creation of the receipts dvi timed out after 30 seconds. "
-          "Automatic receipts creation will not work.",
-          QMessageBox::Ok};
-      message_box.exec();
-      delete process;
-      process = nullptr;
-      return;
-    }
-    delete process;
-    process = nullptr;
-
-    // Convert the dvi file to postscript
-    arguments = QStringList{};
-    arguments << "-q*"
-              << "-o" << QString{dateString + ".ps"}
-              << QString{dateString + ".dvi"};
-
-    process = new QProcess{};
-    process->setProcessEnvironment(env);
-    process->setWorkingDirectory(workpath);
-    process->start(dvipsCmd, arguments);
-    if (!process->waitForFinished(processTimeOut)) {
-      emit ErrorOccurred(
-          new QString{
-              "The conversion of the receipts dvi to postscript timed out "
-              "after 30 seconds. Automatic receipts creation will not work."},
-          new QString{"dvi to postscript conversion failed"});
-      delete process;
-      process = nullptr;
-      return;
-    }
-    delete process;
-    process = nullptr;
-
-    // Print the postscript file
-    if (!lprCmd.isEmpty()) {
-      arguments = QStringList{};
-      arguments << QString{workpath + "/" + dateString + ".ps"};
-
-      process = new QProcess{};
-      process->setProcessEnvironment(env);
-      process->setWorkingDirectory(workpath);
-      process->start(lprCmd, arguments);
-      if (!process->waitForFinished(processTimeOut)) {
-        emit ErrorOccurred(
-            new QString{"The receipts postscript file was successfully created "
-                        "but could not be printed."},
-            new QString{"Printing failed"});
-      }
-      delete process;
-      process = nullptr;
-    }
-
-    // Convert the postscript file to pdf
-    if (!ps2pdfCmd.isEmpty()) {
-      arguments = QStringList{};
-      arguments << QString{workpath + "/" + dateString + ".ps"}
-                << QString{workpath + "/" + dateString + ".pdf"};
-
-      process = new QProcess{};
-      process->setProcessEnvironment(env);
-      process->setWorkingDirectory(workpath);
-      process->start(ps2pdfCmd, arguments);
-      if (!process->waitForFinished(processTimeOut)) {
-        emit ErrorOccurred(
-            new QString{"The receipts were successfully printed but the "
-                        "creation of the PDF file failed."},
-            new QString{"PDF creation failed"});
-      }
-      delete process;
-      process = nullptr;
-
-      // Show the postscript file if the conversion succeeded
-      if (!postscriptViewer.isEmpty()) {
-        arguments = QStringList{};
-        arguments << QString{workpath + "/" + dateString + ".ps"};
-
-        process = new QProcess{};
-        process->setProcessEnvironment(env);
-        process->setWorkingDirectory(workpath);
-        process->startDetached(postscriptViewer, arguments);
-        delete process;
-        process = nullptr;
-      }
-    }
-
-    // Clean up the zTree working path
-    if (!rmCmd.isEmpty()) {
-      arguments = QStringList{};
-      arguments << QString{workpath + "/" + dateString + ".aux"}
-                << QString{workpath + "/" + dateString + ".dvi"}
-                << QString{workpath + "/" + dateString + ".log"}
-                << QString{workpath + "/" + dateString + ".tex"};
-
-      process = new QProcess{};
-      process->setProcessEnvironment(env);
-      process->setWorkingDirectory(workpath);
-      process->start(rmCmd, arguments);
-      if (!process->waitForFinished(processTimeOut)) {
-        emit ErrorOccurred(
-            new QString("The cleanup of the temporary files for receipts "
-                        "creation timed out. Some spare files may be left in "
-                        "your zTree working directory."),
-            new QString("Cleanup failed"));
-      }
-      delete process;
-      process = nullptr;
-    }
-
-    emit PrintingFinished();
-  }
-
 public:
+  /*!
+   * \param argRenderedNatively If the receipts were already rendered as PDF
+   * file, which then only needs to be printed and shown
+   * \param argLaTeXHeaderPath The header the TeX file was created from, whose
+   * precompiled format shall be used (empty if none shall be used)
+   */
   explicit ReceiptsPrinter(const QString &argDateString,
-                           const QString &argWorkpath,
+                           const QString &argWorkpath, bool argRenderedNatively,
+                           const QString &argLaTeXHeaderPath,
                            QObject *argParent = nullptr);
 
+  //! Only create the PDF file, without printing or showing anything
+  void SetOnlyCreatePDF(bool argOnlyCreatePDF) {
+    onlyCreatePDF = argOnlyCreatePDF;
+  }
+  void Start();
+
 signals:
   void ErrorOccurred(QString *error_message, QString *heading);
   void PrintingFinished();
+  //! Emitted once the receipts were passed to the printer successfully
+  void Printed();
+
+private slots:
+  void GotPrintJobsFinished(const QStringList &argFiles, bool argSucceeded);
 
 private:
+  //! The steps of the pipeline, each running an external program
+  enum class Stage {
+    BUILD_FORMAT,
+    COMPILE,
+    CONVERT_TO_POSTSCRIPT,
+    CONVERT_TO_PDF,
+    CLEAN_UP
+  };
+
+  void CleanUp();
+  void Compile(bool argUseFormat);
+  void Finish();
+  void FinishIfIdle();
+  static QString GetStageName(Stage argStage);
+  void GotStageFinished(Stage argStage, QProcess *argProcess);
+  void ReportError(const QString &argHeading, const QString &argMessage);
+  void RequestPrint(const QString &argFile);
+  void RunStage(Stage argStage, const QString &argProgram,
+                const QStringList &argArguments, int argTimeout,
+                const QProcessEnvironment &argEnvironment);
+
+  //! Provides the stages' start times
+  QElapsedTimer clock;
   const QString dateString; //! The date string contained in the file paths
   const QString dvipsCmd;
+  //! The precompiled format of the header
+  LaTeXFormatCache formatCache;
   const QString latexCmd;
+  const QString laTeXHeaderPath; //! The header the TeX file was created from
   const QString lprCmd;
+  //! Set if only the PDF file shall be created
+  bool onlyCreatePDF = false;
   const QString postscriptViewer;
+  //! The file waiting to be printed (empty if printing is not pending)
+  QString printedFile;
+  //! The time printing was requested at
+  qint64 printStart = 0;
   const int processTimeOut =
       15000; //! The maximum time which will be granted to a started process
   const QString ps2pdfCmd;
+  const bool renderedNatively =
+      false; //! Set if the receipts were rendered by PdfReceiptsRenderer
   const QString rmCmd;
+  //! The running stages with their start times
+  QHash<QProcess *, qint64> running;
+  //! The durations of all finished stages
+  QStringList stageTimings;
   const QString vncViewer;
   const QString
       workpath; //!< The path were zTree was ordered to store all its data
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <memory>
+
+#include <QDebug>
+
+#include "receiptsprinter.h"
+#include "receiptsscheduler.h"
+#include "settings.h"
+
+extern std::unique_ptr<lc::Settings> settings;
+
+lc::ReceiptsScheduler::ReceiptsScheduler(QObject *argParent)
+    : QObject{argParent} {
+  printMergeTimer.setInterval(1000);
+  printMergeTimer.setSingleShot(true);
+  connect(&printMergeTimer, &QTimer::timeout, this,
+          &ReceiptsScheduler::StartNextPrintJob);
+}
+
+/*!
+ * \brief Forget a job which finished or was deleted and start waiting ones
+ *
+ * \param[in] argPrinter The ReceiptsPrinter instance which ran the job
+ */
+void lc::ReceiptsScheduler::GotJobGone(QObject *const argPrinter) {
+  highPriorityJobs.removeAll(argPrinter);
+  normalPriorityJobs.removeAll(argPrinter);
+  if (runningJobs.remove(argPrinter)) {
+    // Jobs may finish within ReceiptsPrinter::Start() already
+    QTimer::singleShot(0, this, &ReceiptsScheduler::StartNextJobs);
+  }
+}
+
+/*!
+ * \brief Report the result of an 'lpr' run and start the next one if needed
+ *
+ * \param[in] argFiles The files which were printed
+ * \param[in] argSucceeded If 'lpr' succeeded
+ */
+void lc::ReceiptsScheduler::GotPrintJobFinished(const QStringList &argFiles,
+                                                const bool argSucceeded) {
+  printProcess->deleteLater();
+  printProcess = nullptr;
+  if (!argSucceeded) {
+    qWarning() << "Printing" << argFiles << "failed";
+  }
+  emit PrintJobsFinished(argFiles, argSucceeded);
+  if (!pendingPrintFiles.isEmpty() && !printMergeTimer.isActive()) {
+    printMergeTimer.start();
+  }
+}
+
+/*!
+ * \brief Print the given file together with other files requested meanwhile
+ *
+ * PrintJobsFinished() is emitted once the file was passed to the printer.
+ *
+ * \param[in] argFile The file which shall be printed
+ */
+void lc::ReceiptsScheduler::Print(const QString &argFile) {
+  pendingPrintFiles.append(argFile);
+  // Requests arriving while 'lpr' runs are merged into the next run
+  if (!printProcess && !printMergeTimer.isActive()) {
+    printMergeTimer.start();
+  }
+}
+
+void lc::ReceiptsScheduler::StartNextJobs() {
+  const int workers = std::max(1, settings->receiptsWorkers);
+  while (runningJobs.size() < workers &&
+         !(highPriorityJobs.isEmpty() && normalPriorityJobs.isEmpty())) {
+    QObject *const job = highPriorityJobs.isEmpty()
+                             ? normalPriorityJobs.takeFirst()
+                             : highPriorityJobs.takeFirst();
+    runningJobs.insert(job);
+    qDebug() << "Starting a receipts job," << highPriorityJobs.size()
+             << "session and" << normalPriorityJobs.size()
+             << "manual ones are waiting";
+    static_cast<ReceiptsPrinter *>(job)->Start();
+  }
+}
+
+void lc::ReceiptsScheduler::StartNextPrintJob() {
+  if (printProcess || pendingPrintFiles.isEmpty()) {
+    return;
+  }
+  const QStringList files{pendingPrintFiles};
+  pendingPrintFiles.clear();
+  qDebug() << "Printing" << files;
+
+  printProcess = new QProcess{this};
+  connect(printProcess,
+          static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(
+              &QProcess::finished),
+          this,
+          [this, files](const int argExitCode,
+                        const QProcess::ExitStatus argExitStatus) {
+            GotPrintJobFinished(files, argExitStatus == QProcess::NormalExit &&
+                                           argExitCode == 0);
+          });
+  connect(printProcess, &QProcess::errorOccurred, this,
+          [this, files](const QProcess::ProcessError argError) {
+            if (argError == QProcess::FailedToStart) {
+              GotPrintJobFinished(files, false);
+            }
+          });
+  QProcess *const process = printProcess;
+  QTimer::singleShot(15000 * files.size(), process,
+                     [process]() { process->kill(); });
+  printProcess->setProcessEnvironment(QProcessEnvironment::systemEnvironment());
+  printProcess->start(settings->lprCmd, files);
+}
+
+/*!
+ * \brief Queue a receipts job and start it once a worker is available
+ *
+ * \param[in] argPrinter The ReceiptsPrinter instance running the job, which
+ * must not have been started yet
+ * \param[in] argPriority The priority of the job
+ */
+void lc::ReceiptsScheduler::Submit(ReceiptsPrinter *const argPrinter,
+                                   const Priority argPriority) {
+  connect(argPrinter, &ReceiptsPrinter::PrintingFinished, this,
+          [this, argPrinter]() { GotJobGone(argPrinter); });
+  connect(argPrinter, &QObject::destroyed, this,
+          &ReceiptsScheduler::GotJobGone);
+  if (argPriority == Priority::HIGH) {
+    highPriorityJobs.append(argPrinter);
+  } else {
+    normalPriorityJobs.append(argPrinter);
+  }
+  StartNextJobs();
+}
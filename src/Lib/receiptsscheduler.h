@@ -0,0 +1,92 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RECEIPTSSCHEDULER_H
+#define RECEIPTSSCHEDULER_H
+
+#include <QList>
+#include <QProcess>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+namespace lc {
+
+class ReceiptsPrinter;
+
+/*!
+ * \brief Schedules the receipts jobs of all sessions of the lab
+ *
+ * Only a bounded number of receipts jobs runs at the same time, so that
+ * sessions finishing together do not compete for the same cores. Waiting
+ * jobs are started in order, those of live sessions before manual reprints.
+ * Print requests arriving close together are merged into a single 'lpr' run,
+ * so that bursts reach the printer as one job and in a predictable order.
+ */
+class ReceiptsScheduler : public QObject {
+  Q_OBJECT
+
+public:
+  //! The order in which waiting receipts jobs are started
+  enum class Priority {
+    //! Manually requested receipts, e.g. reprints
+    NORMAL,
+    //! Receipts of live sessions whose participants are waiting
+    HIGH
+  };
+
+  explicit ReceiptsScheduler(QObject *argParent = nullptr);
+
+  void Print(const QString &argFile);
+  void Submit(ReceiptsPrinter *argPrinter, Priority argPriority);
+
+signals:
+  /*!
+   * \brief Emitted if an 'lpr' run printing merged print requests finished
+   *
+   * \param argFiles The files which were printed
+   * \param argSucceeded If the files were passed to the printer successfully
+   */
+  void PrintJobsFinished(const QStringList &argFiles, bool argSucceeded);
+
+private slots:
+  void GotJobGone(QObject *argPrinter);
+  void StartNextJobs();
+  void StartNextPrintJob();
+
+private:
+  void GotPrintJobFinished(const QStringList &argFiles, bool argSucceeded);
+
+  //! The waiting jobs of live sessions
+  QList<QObject *> highPriorityJobs;
+  //! The waiting manually requested jobs
+  QList<QObject *> normalPriorityJobs;
+  //! The files waiting to be printed by the next 'lpr' run
+  QStringList pendingPrintFiles;
+  //! Collects print requests arriving close together
+  QTimer printMergeTimer;
+  //! The running 'lpr' process (nullptr if none is running)
+  QProcess *printProcess = nullptr;
+  //! The currently running jobs
+  QSet<QObject *> runningJobs;
+};
+
+} // namespace lc
+
+#endif // RECEIPTSSCHEDULER_H
@@ -22,8 +22,6 @@
 #include "session.h"
 #include "settings.h"
 
-#include <QDir>
-
 extern std::unique_ptr<lc::Settings> settings;
 
 lc::Session::Session(QVector<Client *> &&argAssocClients,
@@ -40,19 +38,11 @@ lc::Session::Session(QVector<Client *> &&argAssocClients,
       printReceiptsForLocalClients{argPrintReceiptsForLocalClients},
       zTreeDataTargetPath{argZTreeDataTargetPath}, zTreeVersionPath{
                                                        argZTreeVersionPath} {
-  // This part ensures, that both class instances are created in the same
-  // minute, so that the payment file name can be guessed correctly
-  QDateTime current_time;
-  current_time = QDateTime::currentDateTime();
-
-  // If in the last three seconds of a minute, wait for the next one to start
-  if (QTime::currentTime().second() > 56) {
-    QTimer::singleShot(5000, this, SLOT(InitializeClasses()));
-  } else {
-    InitializeClasses();
-  }
+  // The receipts handler picks up every payment file created in the session's
+  // directory, so no guessing of the payment file's name is needed anymore
+  InitializeClasses();
 
-  if (!settings->wmctrlCmd.isEmpty()) {
+  if (settings->IsPathAvailable(settings->wmctrlCmd)) {
     QTimer::singleShot(5000, this, SLOT(RenameWindow()));
   }
 }
@@ -77,25 +67,13 @@ QVariant lc::Session::GetDataItem(int argIndex) {
 }
 
 void lc::Session::InitializeClasses() {
-  // Create the new data directory
-  QDir dir{zTreeDataTargetPath};
-  QString date_string(QDateTime::currentDateTime().toString("yyMMdd_hhmm"));
-  if (!dir.mkdir(zTreeDataTargetPath + "/" + date_string + "-" +
-                 QString::number(zTreePort))) {
-    throw lcDataTargetPathCreationFailed{};
-  }
-  zTreeDataTargetPath.append("/" + date_string + "-" +
-                             QString::number(zTreePort));
-  qDebug() << "New session's chosen_zTree_data_target_path:"
-           << zTreeDataTargetPath;
-
+  // The session's directory was already created by the 'SessionStarter'
   zTreeInstance =
       new ZTree{zTreeDataTargetPath, zTreePort, zTreeVersionPath, this};
   connect(zTreeInstance, &ZTree::ZTreeClosed, this, &Session::OnzTreeClosed);
   // Only create a 'Receipts_Handler' instance, if all neccessary variables were
   // set
-  if (latexHeaderName != "None found" && !settings->dvipsCmd.isEmpty() &&
-      !settings->latexCmd.isEmpty()) {
+  if (settings->IsReceiptsTemplateAvailable(latexHeaderName)) {
     new ReceiptsHandler{zTreeDataTargetPath, printReceiptsForLocalClients,
                         anonymousReceiptsPlaceholder, latexHeaderName, this};
   } else {
@@ -56,10 +56,6 @@ public:
    */
   QVariant GetDataItem(int argIndex);
 
-  //! This gets thrown as an exception if the chosen data target path could not
-  //! be created.
-  class lcDataTargetPathCreationFailed {};
-
 signals:
   void SessionFinished(Session *argSession);
 
@@ -82,8 +78,8 @@ private:
   const QString latexHeaderName; //! The name of the chosen LaTeX header
   const bool printReceiptsForLocalClients =
       true; //! True if receipts shall be printed for local clients
-  QString zTreeDataTargetPath;    //! The path were the data of this zTree
-                                  //! instance's session will be saved
+  const QString zTreeDataTargetPath; //! The path were the data of this zTree
+                                     //! instance's session will be saved
   ZTree *zTreeInstance = nullptr; //! The session's zTree instance
   const QString zTreeVersionPath; //! The path to the version of zTree used by
                                   //! this session's instance
@@ -0,0 +1,258 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QTimer>
+#include <QtConcurrent>
+
+#include "lablib.h"
+#include "sessionstarter.h"
+
+namespace {
+/*!
+ * \brief Join the names of the given clients for display
+ *
+ * \param[in] argClients The clients whose names shall be joined
+ *
+ * \return The comma separated names of the clients
+ */
+QString JoinClientNames(const QVector<lc::Client *> &argClients) {
+  QStringList names;
+  for (const auto *const client : argClients) {
+    names.append(client->name);
+  }
+  return names.join(", ");
+}
+} // namespace
+
+/*!
+ * \brief Describe all conflicts in a way suitable for asking the user once
+ *
+ * \return A human readable description of the conflicts
+ */
+QString lc::SessionStarter::Conflicts::Describe() const {
+  QStringList lines;
+  if (portOccupied) {
+    lines.append(SessionStarter::tr(
+        "The chosen port is already occupied by another session."));
+  }
+  if (dataTargetPathMissing) {
+    lines.append(SessionStarter::tr(
+        "The chosen data target path does not exist and will be created."));
+  }
+  if (!runningZLeaves.isEmpty()) {
+    lines.append(
+        SessionStarter::tr("A z-Leaf is already running on %n client(s): %1",
+                           nullptr, runningZLeaves.size())
+            .arg(JoinClientNames(runningZLeaves)));
+  }
+  if (!unreachableClients.isEmpty()) {
+    lines.append(SessionStarter::tr("No z-Leaf can be started on %n "
+                                    "unreachable client(s): %1",
+                                    nullptr, unreachableClients.size())
+                     .arg(JoinClientNames(unreachableClients)));
+  }
+  return lines.join("\n\n");
+}
+
+/*!
+ * \brief Check if the validation found no conflicts at all
+ *
+ * \return 'true' if no conflicts were found, 'false' otherwise
+ */
+bool lc::SessionStarter::Conflicts::IsEmpty() const {
+  return !dataTargetPathMissing && !portOccupied && runningZLeaves.isEmpty() &&
+         unreachableClients.isEmpty();
+}
+
+/*!
+ * \brief Construct a new instance preparing the start of a session
+ *
+ * \param[in] argLablib The instance the session will be created by
+ * \param[in] argParameters The parameters of the session to be started
+ * \param[in] argParent The instance's parent QObject
+ */
+lc::SessionStarter::SessionStarter(Lablib *const argLablib,
+                                   const Parameters &argParameters,
+                                   QObject *const argParent)
+    : QObject{argParent}, lablib{argLablib}, parameters(argParameters) {
+  connect(&pathCheckWatcher, &QFutureWatcher<bool>::finished, this,
+          &SessionStarter::GotDataTargetPathChecked);
+  connect(&pathCreationWatcher, &QFutureWatcher<bool>::finished, this,
+          &SessionStarter::GotDataTargetPathCreated);
+}
+
+/*!
+ * \brief Collect all conflicts the start would run into
+ *
+ * The check of the data target path, which may reside on a slow network
+ * share, runs in the background. Validated() is emitted once it is done.
+ */
+void lc::SessionStarter::Validate() {
+  conflicts = Conflicts{};
+  conflicts.portOccupied =
+      lablib->GetOccupiedPorts().contains(parameters.port);
+  if (parameters.startZLeaves) {
+    for (auto *const client : parameters.clients) {
+      if (client->GetClientState() == Client::State::ZLEAF_RUNNING) {
+        conflicts.runningZLeaves.append(client);
+      } else if (!client->IsReachable() &&
+                 client->GetClientState() != Client::State::BOOTING) {
+        conflicts.unreachableClients.append(client);
+      }
+    }
+  }
+
+  const QString path = parameters.dataTargetPath;
+  pathCheckWatcher.setFuture(
+      QtConcurrent::run([path]() { return QDir{path}.exists(); }));
+}
+
+/*!
+ * \brief Complete the validation with the result of the path check
+ */
+void lc::SessionStarter::GotDataTargetPathChecked() {
+  conflicts.dataTargetPathMissing = !pathCheckWatcher.result();
+  emit Validated();
+}
+
+/*!
+ * \brief Run the start pipeline
+ *
+ * Starting a session on an occupied port is refused.
+ *
+ * \param[in] argRestartRunningZLeaves If z-Leaves already running on the
+ * clients shall be restarted
+ */
+void lc::SessionStarter::Start(const bool argRestartRunningZLeaves) {
+  if (conflicts.portOccupied) {
+    Fail(tr("The port %1 is already occupied by another session.")
+             .arg(parameters.port));
+    return;
+  }
+
+  restartRunningZLeaves = argRestartRunningZLeaves;
+  done = 0;
+  issuedZLeaves = 0;
+  nextZLeaf = 0;
+  total = 2 + (parameters.startZLeaves ? parameters.clients.size() : 0);
+
+  // The session's own directory is created in the background, too, since the
+  // data target path may reside on a slow network share
+  const QString path = parameters.dataTargetPath;
+  sessionPath = path + "/" +
+                QDateTime::currentDateTime().toString("yyMMdd_hhmm") + "-" +
+                QString::number(parameters.port);
+  const QString session = sessionPath;
+  emit ProgressChanged(done, total,
+                       conflicts.dataTargetPathMissing
+                           ? tr("Creating the data target path")
+                           : tr("Creating the session's directory"));
+  pathCreationWatcher.setFuture(QtConcurrent::run([path, session]() {
+    return QDir{}.mkpath(path) && QDir{}.mkdir(session);
+  }));
+}
+
+/*!
+ * \brief Continue the pipeline once the session's directory was created
+ */
+void lc::SessionStarter::GotDataTargetPathCreated() {
+  if (!pathCreationWatcher.result()) {
+    Fail(tr("The session's directory could not be created in the data target "
+            "path '%1'. Please check if it is a valid location and you have "
+            "all needed permissions.")
+             .arg(parameters.dataTargetPath));
+    return;
+  }
+  qDebug() << "New session's chosen_zTree_data_target_path:" << sessionPath;
+  ReportProgress(tr("Created the session's directory"));
+  CreateSession();
+}
+
+/*!
+ * \brief Create the session and prepare its clients for the z-Leaf starts
+ */
+void lc::SessionStarter::CreateSession() {
+  for (auto *const client : parameters.clients) {
+    client->SetSessionPort(parameters.port);
+    client->SetzLeafVersion(parameters.zTreeVersion);
+  }
+
+  lablib->StartNewSession(parameters.clients,
+                          parameters.participNameReplacement,
+                          parameters.printLocalReceipts,
+                          parameters.receiptsHeader, sessionPath,
+                          parameters.port, parameters.zTreeVersion);
+  ReportProgress(tr("Created the session"));
+
+  if (parameters.startZLeaves) {
+    StartNextZLeaf();
+  } else {
+    emit Finished(true, tr("Started the session on port %1")
+                            .arg(parameters.port));
+  }
+}
+
+/*!
+ * \brief Start the z-Leaf on the next client
+ *
+ * The starts are spread over separate event loop iterations, so that the
+ * progress can be displayed while many clients are handled.
+ */
+void lc::SessionStarter::StartNextZLeaf() {
+  if (nextZLeaf >= parameters.clients.size()) {
+    emit Finished(true, tr("Started the session on port %1 and issued %n "
+                           "z-Leaf start(s)",
+                           nullptr, issuedZLeaves)
+                            .arg(parameters.port));
+    return;
+  }
+
+  Client *const client = parameters.clients.at(nextZLeaf++);
+  if (client->StartZLeaf(nullptr, parameters.zLeafCommand,
+                         restartRunningZLeaves)) {
+    ++issuedZLeaves;
+    ReportProgress(tr("Starting z-Leaf on %1").arg(client->name));
+  } else {
+    ReportProgress(tr("Skipped starting z-Leaf on %1").arg(client->name));
+  }
+  QTimer::singleShot(0, this, &SessionStarter::StartNextZLeaf);
+}
+
+/*!
+ * \brief Abort the pipeline with the given message
+ *
+ * \param[in] argMessage A description of the failure
+ */
+void lc::SessionStarter::Fail(const QString &argMessage) {
+  qWarning() << "Starting the session failed:" << argMessage;
+  emit Finished(false, argMessage);
+}
+
+/*!
+ * \brief Count a completed step and report the progress
+ *
+ * \param[in] argStage A description of the completed step
+ */
+void lc::SessionStarter::ReportProgress(const QString &argStage) {
+  ++done;
+  emit ProgressChanged(done, total, argStage);
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SESSIONSTARTER_H
+#define SESSIONSTARTER_H
+
+#include <QFutureWatcher>
+#include <QVector>
+
+#include "client.h"
+
+namespace lc {
+
+class Lablib;
+
+/*!
+ * \brief Starts a session without blocking the user interface
+ *
+ * The start is split into two steps. Validate() collects all conflicts the
+ * start would run into at once, checking the data target path in the
+ * background, so that the user can be asked a single time. Start() then runs
+ * the actual start as a pipeline (creating the data target path, creating the
+ * session, starting the z-Leaves) which reports its progress.
+ */
+class SessionStarter : public QObject {
+  Q_OBJECT
+
+public:
+  //! Everything needed to start a session
+  struct Parameters {
+    //! The clients which shall be associated with the session
+    QVector<Client *> clients;
+    //! The replacement for participant names on anonymous receipts
+    QString participNameReplacement;
+    //! If receipts shall be printed for local clients, too
+    bool printLocalReceipts = false;
+    //! The LaTeX header used for the receipts
+    QString receiptsHeader;
+    //! The path z-Tree shall store its data in
+    QString dataTargetPath;
+    //! The port the session's z-Tree shall listen on
+    quint16 port = 7000;
+    //! The z-Tree version which shall be started
+    QString zTreeVersion;
+    //! If z-Leaves shall be started on the associated clients
+    bool startZLeaves = false;
+    //! The command line starting the z-Leaves on the clients
+    QString zLeafCommand;
+  };
+
+  //! All conflicts found by the validation
+  struct Conflicts {
+    //! The data target path does not exist and would have to be created
+    bool dataTargetPathMissing = false;
+    //! Another session already occupies the chosen port
+    bool portOccupied = false;
+    //! Clients which already run a z-Leaf
+    QVector<Client *> runningZLeaves;
+    //! Clients on which no z-Leaf can be started since they are unreachable
+    QVector<Client *> unreachableClients;
+
+    QString Describe() const;
+    bool IsEmpty() const;
+  };
+
+  SessionStarter(Lablib *argLablib, const Parameters &argParameters,
+                 QObject *argParent = nullptr);
+
+  const Conflicts &GetConflicts() const { return conflicts; }
+  void Start(bool argRestartRunningZLeaves);
+  void Validate();
+
+signals:
+  /*!
+   * \brief Emitted once the start finished or failed
+   *
+   * \param argSuccess 'true' if the session was started, 'false' otherwise
+   * \param argMessage A message describing the outcome
+   */
+  void Finished(bool argSuccess, const QString &argMessage);
+  /*!
+   * \brief Emitted whenever a step of the start pipeline was completed
+   *
+   * \param argDone The number of completed steps
+   * \param argTotal The total number of steps
+   * \param argStage A description of the currently running stage
+   */
+  void ProgressChanged(int argDone, int argTotal, const QString &argStage);
+  /*!
+   * \brief Emitted once the conflicts were collected by Validate()
+   */
+  void Validated();
+
+private slots:
+  void GotDataTargetPathChecked();
+  void GotDataTargetPathCreated();
+  void StartNextZLeaf();
+
+private:
+  void CreateSession();
+  void Fail(const QString &argMessage);
+  void ReportProgress(const QString &argStage);
+
+  //! The conflicts found by the last validation
+  Conflicts conflicts;
+  //! The number of completed steps of the start pipeline
+  int done = 0;
+  //! The number of z-Leaf starts which were actually issued
+  int issuedZLeaves = 0;
+  //! The instance the session will be created by
+  Lablib *const lablib = nullptr;
+  //! Checks in the background if the data target path exists
+  QFutureWatcher<bool> pathCheckWatcher;
+  //! Creates the data target path and the session's directory in the
+  //! background
+  QFutureWatcher<bool> pathCreationWatcher;
+  //! The index of the next client on which a z-Leaf shall be started
+  int nextZLeaf = 0;
+  //! The parameters of the session to be started
+  const Parameters parameters;
+  //! If z-Leaves already running on the clients shall be restarted
+  bool restartRunningZLeaves = false;
+  //! The directory created for the session within the data target path
+  QString sessionPath;
+  //! The total number of steps of the start pipeline
+  int total = 0;
+};
+
+} // namespace lc
+
+#endif // SESSIONSTARTER_H
@@ -21,11 +21,14 @@
 #include <QDir>
 #include <QFile>
 #include <QProcessEnvironment>
+#include <QStandardPaths>
+#include <QtConcurrent>
 
 #include "client.h"
 #include "settings.h"
 
-lc::Settings::Settings(const QSettings &argSettings, QObject *argParent)
+lc::Settings::Settings(const QSettings &argSettings,
+                       Settings *const argPrevious, QObject *argParent)
     : QObject{argParent}, defaultReceiptIndex{GetDefaultReceiptIndex(
                               argSettings)},
       browserCmd{ReadSettingsItem("browser_command",
@@ -136,6 +139,7 @@ lc::Settings::Settings(const QSettings &argSettings, QObject *argParent)
       wineCmd{ReadSettingsItem("wine_command",
                                "Running z-Leaves or z-Tree will be possible.",
                                argSettings, true)},
+      wineserverCmd{GetWineserverCommand(argSettings, wineCmd)},
       wmctrlCmd{ReadSettingsItem(
           "wmctrl_command",
           "Setting zTree's window title to its port number will not work.",
@@ -149,19 +153,48 @@ lc::Settings::Settings(const QSettings &argSettings, QObject *argParent)
                                     true)},
       restartCrashedSessionScript{ReadSettingsItem(
           "restart_crashed_session_script",
-          "Script to be called after session crash", argSettings, false)},
+          "Recovering crashed sessions will not be possible.", argSettings,
+          true)},
       adminUsers{GetAdminUsers(argSettings)},
-      installedLaTeXHeaders{DetectInstalledLaTeXHeaders()},
-      installedZTreeVersions{DetectInstalledzTreeVersions()},
       clientHelpNotificationServerPort{
           GetClientHelpNotificationServerPort(argSettings)},
-      chosenzTreePort{GetInitialPort(argSettings)}, clients{CreateClients(
-                                                        argSettings, pingCmd)},
+      clientActionRetryTimeout{GetClientActionRetryTimeout(argSettings)},
+      prepareClientsAutomatically{
+          argSettings.value("prepare_clients_automatically", false).toBool()},
+      bootWaveSize{argSettings.value("boot_wave_size", 8).toInt()},
+      bootWaveTimeout{argSettings.value("boot_wave_timeout", 90).toInt()},
+      instrumentationEnabled{
+          argSettings.value("enable_instrumentation", false).toBool()},
+      instrumentationLogFile{
+          argSettings
+              .value("instrumentation_log_file",
+                     QStandardPaths::writableLocation(
+                         QStandardPaths::AppDataLocation) +
+                         "/instrumentation.log")
+              .toString()},
+      thumbnailCommand{
+          argSettings
+              .value("thumbnail_command",
+                     "DISPLAY=:0.0 import -window root -resize 320x240 "
+                     "-quality 60 jpg:-")
+              .toString()},
+      thumbnailBudget{argSettings.value("thumbnail_budget", 512).toInt()},
+      thumbnailInterval{argSettings.value("thumbnail_interval", 5).toInt()},
+      receiptsWorkers{argSettings.value("receipts_workers", 2).toInt()},
+      receiptsJournalFile{
+          argSettings
+              .value("receipts_journal_file",
+                     QStandardPaths::writableLocation(
+                         QStandardPaths::AppDataLocation) +
+                         "/receipts_journal")
+              .toString()},
+      chosenzTreePort{GetInitialPort(argSettings)},
+      clientInventory{ReadClientInventory(argSettings)},
+      clients{CreateClients(clientInventory, pingCmd, argPrevious)},
       localzLeafName{ReadSettingsItem(
           "local_zLeaf_name",
           "The local zLeaf default name will default to 'local'.", argSettings,
-          false)},
-      clIPsToClMap{CreateClIPsToClMap(clients)} {
+          false)} {
   // Let the local zLeaf name default to 'local' if none was given in the
   // settings
   if (localzLeafName.isEmpty()) {
@@ -174,7 +207,27 @@ lc::Settings::Settings(const QSettings &argSettings, QObject *argParent)
   } else {
     qDebug() << "The following webcams where loaded:" << webcams;
   }
-  qDebug() << "Detected z-Tree versions" << installedZTreeVersions;
+  if (argPrevious) {
+    // Clients which were not taken over may still be referenced by running
+    // sessions or command executions, so they are kept until shutdown
+    for (auto *const client : argPrevious->clients) {
+      if (client) {
+        client->StopPinging();
+        retiredClients.append(client);
+      }
+    }
+    retiredClients += argPrevious->retiredClients;
+    argPrevious->clients.clear();
+    argPrevious->retiredClients.clear();
+    // Keep the previous check results until the deferred checks re-ran
+    installedReceiptsTemplates = argPrevious->installedReceiptsTemplates;
+    nativeReceiptsTemplates = argPrevious->nativeReceiptsTemplates;
+    installedZTreeVersions = argPrevious->installedZTreeVersions;
+    missingPaths = argPrevious->missingPaths;
+  }
+  connect(&deferredChecksWatcher,
+          &QFutureWatcher<DeferredCheckResults>::finished, this,
+          &Settings::GotDeferredChecksFinished);
 }
 
 lc::Settings::~Settings() {
@@ -182,6 +235,7 @@ lc::Settings::~Settings() {
        ++it) {
     delete *it;
   }
+  qDeleteAll(retiredClients);
 }
 
 bool lc::Settings::CheckPathAndComplain(const QString &argPath,
@@ -196,149 +250,79 @@ bool lc::Settings::CheckPathAndComplain(const QString &argPath,
   return true;
 }
 
-QVector<lc::Client *> lc::Settings::CreateClients(const QSettings &argSettings,
-                                                  const QString &argPingCmd) {
+QVector<lc::Client *>
+lc::Settings::CreateClients(const ClientInventory &argInventory,
+                            const QString &argPingCmd,
+                            Settings *const argPrevious) {
   QVector<Client *> tempClientVec;
-
-  // Get the client quantity to check the value lists for clients creation for
-  // correct length
-  int clientQuantity = 0;
-  if (!argSettings.contains("client_quantity")) {
-    qWarning()
-        << "'client_quantity' was not set. The client quantity will be guessed"
-           " by the amount of client IPs set in 'client_ips'.";
-    clientQuantity = argSettings.value("client_ips", "")
-                         .toString()
-                         .split('/', QString::SkipEmptyParts, Qt::CaseSensitive)
-                         .length();
-    qDebug() << "'clientQuantity':" << clientQuantity;
-  } else {
-    bool ok = true;
-    clientQuantity = argSettings.value("client_quantity").toInt(&ok);
-    if (!ok) {
-      qWarning() << "The variable 'client_quantity' was not convertible to int";
+  tempClientVec.reserve(argInventory.GetSize());
+  for (int i = 0; i < argInventory.GetSize(); ++i) {
+    // Take over unchanged clients, so that their states and sessions persist
+    if (argPrevious) {
+      const int previousIndex =
+          argPrevious->clientInventory.IndexOfIP(argInventory.GetIP(i));
+      Client *const client = previousIndex < 0
+                                 ? nullptr
+                                 : argPrevious->clients.at(previousIndex);
+      if (client && client->mac == argInventory.GetMAC(i) &&
+          client->name == argInventory.GetName(i)) {
+        client->xPosition = argInventory.GetXPosition(i);
+        client->yPosition = argInventory.GetYPosition(i);
+        client->room = argInventory.GetRoom(i);
+        argPrevious->clients[previousIndex] = nullptr;
+        tempClientVec.append(client);
+        continue;
+      }
     }
-    qDebug() << "'clientQuantity':" << clientQuantity;
-  }
-
-  // Create all the clients in the lab
-  QStringList clientIPs =
-      argSettings.value("client_ips")
-          .toString()
-          .split('|', QString::SkipEmptyParts, Qt::CaseSensitive);
-  if (clientIPs.length() != clientQuantity) {
-    qWarning()
-        << "The quantity of client ips does not match the client quantity. "
-           "Client"
-           " creation will fail. No clients will be available for interaction.";
-    return tempClientVec;
-  }
-  qDebug() << "Client IPs:" << clientIPs.join(" / ");
-
-  QStringList clientMACs =
-      argSettings.value("client_macs")
-          .toString()
-          .split('|', QString::SkipEmptyParts, Qt::CaseSensitive);
-  if (clientMACs.length() != clientQuantity) {
-    qWarning()
-        << "The quantity of client macs does not match the client quantity. "
-           "Client"
-           " creation will fail. No clients will be available for interaction.";
-    return tempClientVec;
-  }
-  qDebug() << "Client MACs:" << clientMACs.join(" / ");
-
-  QStringList clientNames =
-      argSettings.value("client_names")
-          .toString()
-          .split('|', QString::SkipEmptyParts, Qt::CaseSensitive);
-  if (clientNames.length() != clientQuantity) {
-    qWarning()
-        << "The quantity of client names does not match the client quantity. "
-           "Client"
-           " creation will fail. No clients will be available for interaction.";
-    return tempClientVec;
-  }
-  qDebug() << "Client names:" << clientNames.join(" / ");
-
-  QStringList clientXPositions =
-      argSettings.value("client_xpos")
-          .toString()
-          .split('|', QString::SkipEmptyParts, Qt::CaseSensitive);
-  if (clientXPositions.length() != clientQuantity) {
-    qWarning() << "The quantity of client x positions does not match the "
-                  "client quantity."
-                  " Client creation will fail. No clients will be available "
-                  "for interaction.";
-    return tempClientVec;
-  }
-  qDebug() << "clientXPositions:" << clientXPositions.join(" / ");
-
-  QStringList clientYPositions =
-      argSettings.value("client_ypos")
-          .toString()
-          .split('|', QString::SkipEmptyParts, Qt::CaseSensitive);
-  if (clientYPositions.length() != clientQuantity) {
-    qWarning() << "The quantity of client y positions does not match the "
-                  "client quantity."
-                  " Client creation will fail. No clients will be available "
-                  "for interaction.";
-    return tempClientVec;
+    tempClientVec.append(new Client{
+        argInventory.GetIP(i), argInventory.GetMAC(i), argInventory.GetName(i),
+        argInventory.GetXPosition(i), argInventory.GetYPosition(i),
+        argInventory.GetRoom(i), argPingCmd});
   }
-  qDebug() << "clientYPositions:" << clientYPositions.join(" / ");
-
-  for (int i = 0; i < clientQuantity; i++) {
-    tempClientVec.append(new Client{clientIPs[i], clientMACs[i], clientNames[i],
-                                    clientXPositions[i].toUShort(),
-                                    clientYPositions[i].toUShort(),
-                                    argPingCmd});
-  }
-
   return tempClientVec;
 }
 
-QMap<QString, lc::Client *>
-lc::Settings::CreateClIPsToClMap(const QVector<Client *> &argClients) {
-  QMap<QString, Client *> tempMap;
-  for (const auto &s : argClients) {
-    tempMap.insert(s->ip, s);
-
-    // Get the address of the Client instance in RAM for display
-    const void *clientPtrAddr = static_cast<const void *>(tempMap[s->ip]);
-
-    qDebug() << "Added" << s->name
-             << "to 'clientIPsToClientsMap':" << clientPtrAddr;
-  }
-  return tempMap;
-}
-
-QStringList lc::Settings::DetectInstalledLaTeXHeaders() const {
-  QStringList tempLaTeXHeaders{"None found"};
-  // Detect the installed LaTeX headers
-  if (!lcDataDir.isEmpty()) {
-    QDir laTeXDirectory{lcDataDir, "*_header.tex", QDir::Name,
+QStringList lc::Settings::DetectInstalledReceiptsTemplates(
+    const QString &argLcDataDir, QStringList &argNativeTemplates) {
+  QStringList tempReceiptsTemplates;
+  argNativeTemplates.clear();
+  // Detect the installed LaTeX headers and native receipts templates
+  if (!argLcDataDir.isEmpty()) {
+    QDir laTeXDirectory{argLcDataDir, "*_header.tex", QDir::Name,
                         QDir::CaseSensitive | QDir::Files | QDir::Readable};
-    if (!laTeXDirectory.exists() || laTeXDirectory.entryList().isEmpty()) {
-      qDebug() << "Receipts printing will not work. No LaTeX headers could be "
-                  "found in"
-               << lcDataDir;
+    QStringList laTeXHeaders{laTeXDirectory.entryList()};
+    laTeXHeaders.replaceInStrings("_header.tex", "");
+    QDir nativeDirectory{argLcDataDir, "*_receipt.json", QDir::Name,
+                         QDir::CaseSensitive | QDir::Files | QDir::Readable};
+    QStringList nativeTemplates{nativeDirectory.entryList()};
+    nativeTemplates.replaceInStrings("_receipt.json", "");
+    argNativeTemplates = nativeTemplates;
+
+    QStringList receiptsTemplates{laTeXHeaders + nativeTemplates};
+    receiptsTemplates.removeDuplicates();
+    receiptsTemplates.sort();
+    if (receiptsTemplates.isEmpty()) {
+      qDebug() << "Receipts printing will not work. No LaTeX headers or"
+                  " receipts templates could be found in"
+               << argLcDataDir;
     } else {
-      tempLaTeXHeaders = laTeXDirectory.entryList();
-      tempLaTeXHeaders.replaceInStrings("_header.tex", "");
-      qDebug() << "LaTeX headers:" << tempLaTeXHeaders.join(" / ");
+      tempReceiptsTemplates = receiptsTemplates;
+      qDebug() << "LaTeX headers:" << laTeXHeaders.join(" / ");
+      qDebug() << "Native receipts templates:" << nativeTemplates.join(" / ");
     }
   }
-  return tempLaTeXHeaders;
+  return tempReceiptsTemplates;
 }
 
-QStringList lc::Settings::DetectInstalledzTreeVersions() const {
+QStringList
+lc::Settings::DetectInstalledzTreeVersions(const QString &argZTreeInstDir) {
   QStringList tempInstzTreeVersions;
-  if (!zTreeInstDir.isEmpty()) {
-    QDir zTreeDirectory{zTreeInstDir, "zTree_*", QDir::Name,
+  if (!argZTreeInstDir.isEmpty()) {
+    QDir zTreeDirectory{argZTreeInstDir, "zTree_*", QDir::Name,
                         QDir::NoDotAndDotDot | QDir::Dirs | QDir::Readable |
                             QDir::CaseSensitive};
     if (zTreeDirectory.entryList().isEmpty()) {
-      qWarning() << "No zTree versions could be found in" << zTreeInstDir;
+      qWarning() << "No zTree versions could be found in" << argZTreeInstDir;
     } else {
       tempInstzTreeVersions = zTreeDirectory.entryList();
       tempInstzTreeVersions.replaceInStrings("zTree_", "");
@@ -364,6 +348,24 @@ QStringList lc::Settings::GetAdminUsers(const QSettings &argSettings) {
   return QStringList{};
 }
 
+lc::Client *lc::Settings::GetClientByIP(const QString &argIP) const {
+  const int index = clientInventory.IndexOfIP(argIP);
+  return index < 0 ? nullptr : clients.at(index);
+}
+
+int lc::Settings::GetClientActionRetryTimeout(const QSettings &argSettings) {
+  // Read the time in seconds within which failed client actions are retried
+  if (!argSettings.contains("client_action_retry_timeout")) {
+    qDebug() << "'client_action_retry_timeout' was not set. Failed client"
+                " actions will be retried for 120 seconds.";
+    return 120;
+  }
+  const int retryTimeout =
+      argSettings.value("client_action_retry_timeout", 120).toInt();
+  qDebug() << "'clientActionRetryTimeout':" << retryTimeout;
+  return retryTimeout;
+}
+
 quint16 lc::Settings::GetClientHelpNotificationServerPort(
     const QSettings &argSettings) {
   // Read the port the ClientHelpNotificationServer shall listen on
@@ -422,6 +424,36 @@ QString lc::Settings::GetLocalUserName() {
   return userName;
 }
 
+QString lc::Settings::GetWineserverCommand(const QSettings &argSettings,
+                                           const QString &argWineCmd) {
+  // The path refers to the clients, so it cannot be checked for existence
+  if (argSettings.contains("wineserver_command")) {
+    const QString wineserverCmd{
+        argSettings.value("wineserver_command").toString()};
+    qDebug() << "'wineserverCmd':" << wineserverCmd;
+    return wineserverCmd;
+  }
+  if (argWineCmd.isEmpty()) {
+    return QString{};
+  }
+  // Default to the 'wineserver' residing beside the 'wine' binary
+  const QString wineserverCmd{argWineCmd.left(argWineCmd.lastIndexOf('/') + 1) +
+                              "wineserver"};
+  qDebug() << "'wineserver_command' was not set, defaulting to"
+           << wineserverCmd;
+  return wineserverCmd;
+}
+
+lc::ClientInventory
+lc::Settings::ReadClientInventory(const QSettings &argSettings) {
+  // A roster file takes precedence over the lists in the settings
+  if (argSettings.contains("client_roster")) {
+    return ClientInventory::FromRoster(
+        argSettings.value("client_roster").toString());
+  }
+  return ClientInventory::FromSettings(argSettings);
+}
+
 QString lc::Settings::ReadSettingsItem(const QString &argVariableName,
                                        const QString &argMessage,
                                        const QSettings &argSettings,
@@ -430,16 +462,98 @@ QString lc::Settings::ReadSettingsItem(const QString &argVariableName,
     qDebug() << argVariableName << "was not set." << argMessage;
     return QString{};
   } else {
-    QString tempString{argSettings.value(argVariableName).toString()};
-    if (argItemIsFile &&
-        !CheckPathAndComplain(tempString, argVariableName, argMessage)) {
-      tempString.clear();
+    const QString tempString{argSettings.value(argVariableName).toString()};
+    // The existence of files is checked by RunDeferredChecks() later
+    if (argItemIsFile) {
+      pathChecks.append(PathCheck{argVariableName, tempString, argMessage});
     }
     return tempString;
   }
   return QString{};
 }
 
+bool lc::Settings::AreReceiptsAvailable() const {
+  return !GetAvailableReceiptsTemplates().isEmpty();
+}
+
+/*!
+ * \brief Return the installed receipts templates whose components are present
+ */
+QStringList lc::Settings::GetAvailableReceiptsTemplates() const {
+  QStringList availableTemplates;
+  for (const auto &templateName : installedReceiptsTemplates) {
+    if (IsReceiptsTemplateAvailable(templateName)) {
+      availableTemplates.append(templateName);
+    }
+  }
+  return availableTemplates;
+}
+
+bool lc::Settings::IsPathAvailable(const QString &argPath) const {
+  return !argPath.isEmpty() && !missingPaths.contains(argPath);
+}
+
+/*!
+ * \brief Check if receipts can be created and printed with the given template
+ *
+ * \param[in] argTemplateName The name of the receipts template
+ */
+bool lc::Settings::IsReceiptsTemplateAvailable(
+    const QString &argTemplateName) const {
+  if (!IsPathAvailable(lcDataDir) ||
+      !installedReceiptsTemplates.contains(argTemplateName)) {
+    return false;
+  }
+  // Native receipts templates are rendered without the LaTeX tool chain
+  if (nativeReceiptsTemplates.contains(argTemplateName)) {
+    return true;
+  }
+  return IsPathAvailable(dvipsCmd) && IsPathAvailable(latexCmd) &&
+         IsPathAvailable(lprCmd) && IsPathAvailable(postscriptViewer) &&
+         IsPathAvailable(ps2pdfCmd) && IsPathAvailable(rmCmd) &&
+         IsPathAvailable(vncViewer);
+}
+
+void lc::Settings::RunDeferredChecks() {
+  if (deferredChecksWatcher.isRunning()) {
+    return;
+  }
+  const QVector<PathCheck> checks{pathChecks};
+  const QString dataDir{lcDataDir};
+  const QString instDir{zTreeInstDir};
+  deferredChecksWatcher.setFuture(
+      QtConcurrent::run([checks, dataDir, instDir]() {
+        return RunChecks(checks, dataDir, instDir);
+      }));
+}
+
+lc::Settings::DeferredCheckResults
+lc::Settings::RunChecks(const QVector<PathCheck> &argPathChecks,
+                        const QString &argLcDataDir,
+                        const QString &argZTreeInstDir) {
+  DeferredCheckResults results;
+  for (const auto &check : argPathChecks) {
+    if (!CheckPathAndComplain(check.path, check.variableName, check.message)) {
+      results.missingPaths.insert(check.path);
+    }
+  }
+  results.installedReceiptsTemplates = DetectInstalledReceiptsTemplates(
+      argLcDataDir, results.nativeReceiptsTemplates);
+  results.installedZTreeVersions =
+      DetectInstalledzTreeVersions(argZTreeInstDir);
+  return results;
+}
+
+void lc::Settings::GotDeferredChecksFinished() {
+  const DeferredCheckResults results{deferredChecksWatcher.result()};
+  installedReceiptsTemplates = results.installedReceiptsTemplates;
+  nativeReceiptsTemplates = results.nativeReceiptsTemplates;
+  installedZTreeVersions = results.installedZTreeVersions;
+  missingPaths = results.missingPaths;
+  qDebug() << "Detected z-Tree versions" << installedZTreeVersions;
+  emit DeferredChecksFinished();
+}
+
 void lc::Settings::SetLocalzLeafSize(QString arg) { localzLeafSize = arg; }
 
 void lc::Settings::SetChosenZTreePort(const int argPort) {
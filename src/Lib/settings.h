@@ -21,28 +21,71 @@
 #define SETTINGS_H
 
 #include <QDebug>
+#include <QFutureWatcher>
 #include <QObject>
+#include <QSet>
 #include <QSettings>
 
 #include "client.h"
+#include "clientinventory.h"
 
 namespace lc {
 
 class Settings : public QObject {
   Q_OBJECT
 
+  //! A configured path whose existence is checked in the background
+  struct PathCheck {
+    QString variableName;
+    QString path;
+    QString message;
+  };
+  //! The results of the checks deferred until after the startup
+  struct DeferredCheckResults {
+    QStringList installedReceiptsTemplates;
+    QStringList installedZTreeVersions;
+    QSet<QString> missingPaths;
+    QStringList nativeReceiptsTemplates;
+  };
+
+  //! The paths to be checked (declared first since it is filled by the
+  //! initialization of the other members)
+  QVector<PathCheck> pathChecks;
+
 public:
   Settings() = delete;
-  explicit Settings(const QSettings &argSettings, QObject *argParent = nullptr);
+  /*!
+   * \brief Settings' constructor
+   * \param argSettings The settings to be read
+   * \param argPrevious The settings being replaced on a reload, whose clients
+   * are taken over if they are still configured unchanged
+   * \param argParent This instance's parent QObject
+   */
+  explicit Settings(const QSettings &argSettings,
+                    Settings *argPrevious = nullptr,
+                    QObject *argParent = nullptr);
   Settings(const Settings &argSettings) = delete;
   Settings &operator=(const Settings &argSettings) = delete;
   Settings(Settings &&argSettings) = delete;
   Settings &operator=(Settings &&argSettings) = delete;
   ~Settings();
 
+  bool AreReceiptsAvailable() const;
+  QStringList GetAvailableReceiptsTemplates() const;
   int GetChosenZTreePort() const { return chosenzTreePort; }
+  Client *GetClientByIP(const QString &argIP) const;
+  const ClientInventory &GetClientInventory() const { return clientInventory; }
   QVector<Client *> &GetClients() { return clients; }
+  const QStringList &GetInstalledReceiptsTemplates() const {
+    return installedReceiptsTemplates;
+  }
+  const QStringList &GetInstalledZTreeVersions() const {
+    return installedZTreeVersions;
+  }
   QString GetLocalzLeafName() const;
+  bool IsPathAvailable(const QString &argPath) const;
+  bool IsReceiptsTemplateAvailable(const QString &argTemplateName) const;
+  void RunDeferredChecks();
   void SetChosenZTreePort(const int argPort);
   void SetLocalzLeafName(const QString &argLocalzLeafName);
 
@@ -81,42 +124,78 @@ public:
   const QStringList webcams;
   const QStringList webcams_names;
   const QString wineCmd;
+  const QString wineserverCmd;
   const QString wmctrlCmd;
   const QString xsetCmd;
   const QString zTreeInstDir;
   const QString restartCrashedSessionScript;
   const QStringList adminUsers;
-  const QStringList installedLaTeXHeaders;
-  const QStringList installedZTreeVersions;
   const quint16 clientHelpNotificationServerPort = 0;
+  const int clientActionRetryTimeout = 120;
+  const bool prepareClientsAutomatically = false;
+  const int bootWaveSize = 8;
+  const int bootWaveTimeout = 90;
+  const bool instrumentationEnabled = false;
+  const QString instrumentationLogFile;
+  const QString thumbnailCommand;
+  const int thumbnailBudget = 512;
+  const int thumbnailInterval = 5;
+  const int receiptsWorkers = 2;
+  const QString receiptsJournalFile;
+
+signals:
+  /*!
+   * \brief Emitted once the checks started by RunDeferredChecks() finished
+   */
+  void DeferredChecksFinished();
+
+private slots:
+  void GotDeferredChecksFinished();
 
 private:
   static bool CheckPathAndComplain(const QString &argPath,
                                    const QString &argVariableName,
                                    const QString &argMessage);
-  static QVector<Client *> CreateClients(const QSettings &argSettings,
-                                         const QString &argPingCmd);
-  static QMap<QString, Client *>
-  CreateClIPsToClMap(const QVector<Client *> &argClients);
-  QStringList DetectInstalledLaTeXHeaders() const;
-  QStringList DetectInstalledzTreeVersions() const;
+  static QVector<Client *> CreateClients(const ClientInventory &argInventory,
+                                         const QString &argPingCmd,
+                                         Settings *argPrevious);
+  static QStringList
+  DetectInstalledReceiptsTemplates(const QString &argLcDataDir,
+                                   QStringList &argNativeTemplates);
+  static QStringList
+  DetectInstalledzTreeVersions(const QString &argZTreeInstDir);
   static QStringList GetAdminUsers(const QSettings &argSettings);
+  static int GetClientActionRetryTimeout(const QSettings &argSettings);
   static quint16
   GetClientHelpNotificationServerPort(const QSettings &argSettings);
   static int GetDefaultReceiptIndex(const QSettings &argSettings);
   static int GetInitialPort(const QSettings &argSettings);
   static QString GetLocalUserName();
-  static QString ReadSettingsItem(const QString &argVariableName,
-                                  const QString &argMessage,
-                                  const QSettings &argSettings,
-                                  bool argItemIsFile);
+  static QString GetWineserverCommand(const QSettings &argSettings,
+                                      const QString &argWineCmd);
+  static ClientInventory ReadClientInventory(const QSettings &argSettings);
+  static DeferredCheckResults
+  RunChecks(const QVector<PathCheck> &argPathChecks,
+            const QString &argLcDataDir, const QString &argZTreeInstDir);
+  QString ReadSettingsItem(const QString &argVariableName,
+                           const QString &argMessage,
+                           const QSettings &argSettings, bool argItemIsFile);
 
   int chosenzTreePort = 0;
+  //! The inventory the clients were created from (in the same order)
+  const ClientInventory clientInventory;
   QVector<Client *> clients;
+  //! Runs the deferred checks in the background
+  QFutureWatcher<DeferredCheckResults> deferredChecksWatcher;
+  QStringList installedReceiptsTemplates;
+  QStringList installedZTreeVersions;
   QString localzLeafName;
-
-public:
-  const QMap<QString, Client *> clIPsToClMap;
+  //! The configured paths which were found to be missing
+  QSet<QString> missingPaths;
+  //! The receipts templates found for the native PDF renderer
+  QStringList nativeReceiptsTemplates;
+  //! Clients removed by reloads which may still be referenced by sessions
+  QVector<Client *> retiredClients;
 };
 
 } // namespace lc
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+
+#include <QDebug>
+#include <QFile>
+#include <QSet>
+#include <QSettings>
+
+#include "settings.h"
+#include "settingsreloader.h"
+
+extern std::unique_ptr<lc::Settings> settings;
+
+/*!
+ * \brief Construct a new settings reloader and start watching the files
+ *
+ * \param[in] argParent The instance's parent QObject
+ */
+lc::SettingsReloader::SettingsReloader(QObject *const argParent)
+    : QObject{argParent}, watcher{this} {
+  debounceTimer.setInterval(500);
+  debounceTimer.setSingleShot(true);
+  connect(&debounceTimer, &QTimer::timeout, this, &SettingsReloader::Reload);
+  connect(&watcher, &QFileSystemWatcher::fileChanged, this,
+          &SettingsReloader::GotFileChanged);
+  WatchFiles();
+}
+
+/*!
+ * \brief (Re)start the delay until the settings are reloaded
+ *
+ * Editors often replace files instead of writing them, which removes them from
+ * the watcher. Therefore they are watched again on the reload.
+ *
+ * \param[in] argPath The path of the changed file
+ */
+void lc::SettingsReloader::GotFileChanged(const QString &argPath) {
+  qDebug() << "The settings file" << argPath << "was changed";
+  debounceTimer.start();
+}
+
+/*!
+ * \brief Read the settings anew and replace the global ones
+ *
+ * The previous settings are destroyed only after all receivers of
+ * 'SettingsReloaded' switched over to the new ones.
+ */
+void lc::SettingsReloader::Reload() {
+  WatchFiles();
+
+  const QVector<Client *> previousClients{settings->GetClients()};
+  // After the swap 'next' holds the previous settings until the end
+  std::unique_ptr<Settings> next{
+      new Settings{QSettings{"Labcontrol", "Labcontrol"}, settings.get()}};
+  next->SetChosenZTreePort(settings->GetChosenZTreePort());
+  settings.swap(next);
+
+  const QSet<Client *> oldClients{previousClients.toList().toSet()};
+  const QSet<Client *> newClients{settings->GetClients().toList().toSet()};
+  const int addedClients = (newClients - oldClients).size();
+  const int removedClients = (oldClients - newClients).size();
+  qDebug() << "Reloaded the settings," << addedClients << "clients were added"
+           << "and" << removedClients << "were removed";
+
+  emit SettingsReloaded(addedClients, removedClients);
+  settings->RunDeferredChecks();
+}
+
+/*!
+ * \brief Add all existing settings files to the watcher
+ */
+void lc::SettingsReloader::WatchFiles() {
+  QStringList files{
+      QSettings{"Labcontrol", "Labcontrol"}.fileName(),
+      QSettings{QSettings::SystemScope, "Labcontrol", "Labcontrol"}
+          .fileName()};
+  const QString roster{
+      QSettings{"Labcontrol", "Labcontrol"}.value("client_roster").toString()};
+  if (!roster.isEmpty()) {
+    files.append(roster);
+  }
+  for (const auto &file : files) {
+    if (QFile::exists(file) && !watcher.files().contains(file)) {
+      watcher.addPath(file);
+    }
+  }
+}
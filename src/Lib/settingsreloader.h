@@ -0,0 +1,67 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SETTINGSRELOADER_H
+#define SETTINGSRELOADER_H
+
+#include <QFileSystemWatcher>
+#include <QStringList>
+#include <QTimer>
+
+namespace lc {
+
+/*!
+ * \brief Reloads the settings if 'Labcontrol.conf' was modified
+ *
+ * The user's and the system's configuration files and the client roster are
+ * watched. Once they were left untouched for a moment, new settings are read
+ * and replace the current ones. Clients which are still configured unchanged
+ * are taken over with their states, so that running sessions continue
+ * undisturbed.
+ */
+class SettingsReloader : public QObject {
+  Q_OBJECT
+
+public:
+  explicit SettingsReloader(QObject *argParent = nullptr);
+
+signals:
+  /*!
+   * \brief Emitted after the global settings were replaced
+   *
+   * \param argAddedClients The number of clients which were newly created
+   * \param argRemovedClients The number of clients which were retired
+   */
+  void SettingsReloaded(int argAddedClients, int argRemovedClients);
+
+private slots:
+  void GotFileChanged(const QString &argPath);
+  void Reload();
+
+private:
+  void WatchFiles();
+
+  //! Delays the reload until the files were left untouched for a moment
+  QTimer debounceTimer;
+  QFileSystemWatcher watcher;
+};
+
+} // namespace lc
+
+#endif // SETTINGSRELOADER_H
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QDebug>
+
+#include "startupprofiler.h"
+
+/*!
+ * \brief Construct a new profiler, starting the first phase
+ */
+lc::StartupProfiler::StartupProfiler() { clock.start(); }
+
+/*!
+ * \brief Summarize the durations of all completed phases
+ *
+ * \return A human readable report of the startup's phases
+ */
+QString lc::StartupProfiler::CreateReport() const {
+  QString report{tr("Startup phases:\n")};
+  qint64 previousEnd = 0;
+  for (const auto &phase : phases) {
+    report.append(tr("  %1: %2 ms (after %3 ms)\n")
+                      .arg(phase.name)
+                      .arg(phase.end - previousEnd)
+                      .arg(phase.end));
+    previousEnd = phase.end;
+  }
+  return report;
+}
+
+/*!
+ * \brief Mark the end of the current phase and start the next one
+ *
+ * \param[in] argPhase The name of the phase which ended
+ */
+void lc::StartupProfiler::Mark(const QString &argPhase) {
+  Phase phase;
+  phase.name = argPhase;
+  phase.end = clock.elapsed();
+  const qint64 duration =
+      phase.end - (phases.isEmpty() ? 0 : phases.last().end);
+  phases.append(phase);
+  qDebug() << "Startup phase" << argPhase << "took" << duration << "ms";
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QVector>
+
+namespace lc {
+
+/*!
+ * \brief Times the phases of Labcontrol's startup
+ *
+ * The end of every phase is marked with its name. The time each phase took is
+ * logged immediately and can be summarized in a report.
+ */
+class StartupProfiler {
+  Q_DECLARE_TR_FUNCTIONS(StartupProfiler)
+
+public:
+  StartupProfiler();
+
+  QString CreateReport() const;
+  void Mark(const QString &argPhase);
+
+private:
+  //! A completed phase of the startup
+  struct Phase {
+    //! The name of the phase
+    QString name;
+    //! The milliseconds since the start of the profiler the phase ended at
+    qint64 end = 0;
+  };
+
+  //! Measures the time since the start of the profiler
+  QElapsedTimer clock;
+  //! All completed phases in the order they ended in
+  QVector<Phase> phases;
+};
+
+} // namespace lc
+
+#endif // STARTUPPROFILER_H
@@ -0,0 +1,206 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+
+#include <QDebug>
+
+#include "settings.h"
+#include "thumbnailpoller.h"
+
+extern std::unique_ptr<lc::Settings> settings;
+
+namespace {
+//! The interval in milliseconds in which new fetches are considered
+const int tickInterval = 200;
+//! The time in milliseconds after which a hanging fetch is aborted
+const int snapshotTimeout = 10000;
+} // namespace
+
+/*!
+ * \brief Construct a new poller for the given clients' screens
+ *
+ * \param[in] argClients The clients whose screens shall be polled
+ * \param[in] argParent The instance's parent QObject
+ */
+lc::ThumbnailPoller::ThumbnailPoller(const QVector<Client *> &argClients,
+                                     QObject *const argParent)
+    : QObject{argParent}, clients{argClients} {
+  clock.start();
+  tickTimer.setInterval(tickInterval);
+  connect(&tickTimer, &QTimer::timeout, this, &ThumbnailPoller::Tick);
+}
+
+lc::ThumbnailPoller::~ThumbnailPoller() { Stop(); }
+
+/*!
+ * \brief Return the time since the given frame was fetched
+ *
+ * \param[in] argFrame The frame whose age shall be returned
+ *
+ * \return The frame's age in milliseconds (-1 if it was never fetched)
+ */
+qint64 lc::ThumbnailPoller::GetAge(const Frame &argFrame) const {
+  if (argFrame.fetched < 0) {
+    return -1;
+  }
+  return clock.elapsed() - argFrame.fetched;
+}
+
+/*!
+ * \brief Poll the screens of the given clients from now on
+ *
+ * The frames of clients which are still polled are kept.
+ *
+ * \param[in] argClients The clients whose screens shall be polled
+ */
+void lc::ThumbnailPoller::SetClients(const QVector<Client *> &argClients) {
+  for (auto *const client : clients) {
+    if (!argClients.contains(client)) {
+      frames.remove(client);
+      lastRequests.remove(client);
+    }
+  }
+  clients = argClients;
+  nextClient = 0;
+}
+
+/*!
+ * \brief Start polling the clients' screens
+ */
+void lc::ThumbnailPoller::Start() {
+  if (IsRunning() || !settings->IsPathAvailable(settings->sshCmd) ||
+      settings->thumbnailCommand.isEmpty()) {
+    return;
+  }
+  lastRefill = clock.elapsed();
+  availableBytes = 0;
+  tickTimer.start();
+  Tick();
+}
+
+/*!
+ * \brief Stop polling and abort all running fetches
+ *
+ * The cached frames are kept.
+ */
+void lc::ThumbnailPoller::Stop() {
+  tickTimer.stop();
+  for (auto *const process : running) {
+    disconnect(process, nullptr, this, nullptr);
+    process->kill();
+    process->deleteLater();
+  }
+  running.clear();
+}
+
+/*!
+ * \brief Refill the budget and start as many fetches as it allows
+ */
+void lc::ThumbnailPoller::Tick() {
+  // Allow bursts of at most one second's budget
+  const qint64 budget = static_cast<qint64>(settings->thumbnailBudget) * 1024;
+  const qint64 now = clock.elapsed();
+  availableBytes =
+      qMin(budget, availableBytes + budget * (now - lastRefill) / 1000);
+  lastRefill = now;
+
+  // Visit every client at most once per tick
+  const qint64 interval =
+      static_cast<qint64>(settings->thumbnailInterval) * 1000;
+  for (int visited = 0; visited < clients.size() && availableBytes > 0 &&
+                        running.size() < maxRunning;
+       ++visited) {
+    Client *const client = clients.at(nextClient);
+    nextClient = (nextClient + 1) % clients.size();
+    if (client->GetClientState() < Client::State::RESPONDING) {
+      continue;
+    }
+    const qint64 lastRequest = lastRequests.value(client, -1);
+    if (lastRequest >= 0 && now - lastRequest < interval) {
+      continue;
+    }
+    Fetch(client);
+  }
+}
+
+/*!
+ * \brief Start fetching a snapshot of the given client's screen
+ *
+ * \param[in] argClient The client whose screen shall be fetched
+ */
+void lc::ThumbnailPoller::Fetch(Client *const argClient) {
+  lastRequests.insert(argClient, clock.elapsed());
+
+  QProcess *const process = new QProcess{this};
+  running.append(process);
+  connect(process,
+          static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(
+              &QProcess::finished),
+          this,
+          [this, argClient, process]() { GotSnapshot(argClient, process); });
+  connect(process, &QProcess::errorOccurred, this,
+          [this, argClient, process](const QProcess::ProcessError argError) {
+            if (argError == QProcess::FailedToStart) {
+              GotSnapshot(argClient, process);
+            }
+          });
+  QTimer::singleShot(snapshotTimeout, process,
+                     [process]() { process->kill(); });
+
+  process->start(settings->sshCmd,
+                 QStringList{} << "-o"
+                               << "ConnectTimeout=5"
+                               << "-i" << settings->pkeyPathUser
+                               << QString{settings->userNameOnClients + "@" +
+                                          argClient->ip}
+                               << settings->thumbnailCommand);
+}
+
+/*!
+ * \brief Decode and cache a fetched snapshot and account for its size
+ *
+ * \param[in] argClient The client the snapshot was fetched from
+ * \param[in] argProcess The process which fetched the snapshot
+ */
+void lc::ThumbnailPoller::GotSnapshot(Client *const argClient,
+                                      QProcess *const argProcess) {
+  if (!running.removeOne(argProcess)) {
+    return;
+  }
+  argProcess->deleteLater();
+
+  const QByteArray data = argProcess->readAllStandardOutput();
+  availableBytes -= data.size();
+  // The client may have been removed while its snapshot was fetched
+  if (!clients.contains(argClient)) {
+    return;
+  }
+  QImage image;
+  if (argProcess->exitStatus() != QProcess::NormalExit ||
+      argProcess->exitCode() != 0 || !image.loadFromData(data)) {
+    qDebug() << "Fetching a snapshot of" << argClient->name << "failed";
+    return;
+  }
+
+  Frame &frame = frames[argClient];
+  frame.image = image;
+  frame.fetched = clock.elapsed();
+  emit FrameUpdated(argClient);
+}
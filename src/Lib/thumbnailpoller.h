@@ -0,0 +1,107 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THUMBNAILPOLLER_H
+#define THUMBNAILPOLLER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QImage>
+#include <QProcess>
+#include <QTimer>
+#include <QVector>
+
+#include "client.h"
+
+namespace lc {
+
+/*!
+ * \brief Polls low resolution snapshots of the clients' screens
+ *
+ * The reachable clients are visited on a rotating schedule, fetching a
+ * snapshot via 'ssh' from at most a few clients at once. The transferred
+ * bytes are accounted in a token bucket refilled with the configured budget,
+ * so that the bandwidth used stays bounded independent of the number of
+ * clients. The last frame of every client is cached.
+ */
+class ThumbnailPoller : public QObject {
+  Q_OBJECT
+
+public:
+  //! A cached snapshot of a client's screen
+  struct Frame {
+    //! The snapshot (null if none was fetched yet)
+    QImage image;
+    //! The time the snapshot was fetched at (on the poller's clock)
+    qint64 fetched = -1;
+  };
+
+  explicit ThumbnailPoller(const QVector<Client *> &argClients,
+                           QObject *argParent = nullptr);
+  ~ThumbnailPoller();
+
+  qint64 GetAge(const Frame &argFrame) const;
+  Frame GetFrame(const Client *argClient) const {
+    return frames.value(argClient);
+  }
+  bool IsRunning() const { return tickTimer.isActive(); }
+  void SetClients(const QVector<Client *> &argClients);
+  void Start();
+  void Stop();
+
+signals:
+  /*!
+   * \brief Emitted whenever a new snapshot of a client was fetched
+   *
+   * \param argClient The client whose snapshot was updated
+   */
+  void FrameUpdated(lc::Client *argClient);
+
+private slots:
+  void Tick();
+
+private:
+  void Fetch(Client *argClient);
+  void GotSnapshot(Client *argClient, QProcess *argProcess);
+
+  //! The bytes which may still be transferred (negative if overdrawn)
+  qint64 availableBytes = 0;
+  //! The clients whose screens are polled
+  QVector<Client *> clients;
+  //! Provides monotonic time stamps for the frames and the budget
+  QElapsedTimer clock;
+  //! The last snapshot of every client
+  QHash<const Client *, Frame> frames;
+  //! The time the budget was last refilled at
+  qint64 lastRefill = 0;
+  //! The time the last snapshot of every client was requested at
+  QHash<const Client *, qint64> lastRequests;
+  //! The maximum number of snapshots being fetched at once
+  const int maxRunning = 4;
+  //! The index of the client which is considered next
+  int nextClient = 0;
+  //! The processes currently fetching snapshots
+  QVector<QProcess *> running;
+  //! Regularly starts fetching snapshots as the budget allows
+  QTimer tickTimer;
+};
+
+} // namespace lc
+
+#endif // THUMBNAILPOLLER_H
@@ -0,0 +1,219 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include <QDebug>
+#include <QMap>
+
+#include "zleafstarttracer.h"
+
+namespace {
+/*!
+ * \brief Format a duration in milliseconds as seconds for the report
+ *
+ * \param[in] argDuration The duration in milliseconds (-1 if not reached)
+ *
+ * \return The formatted duration
+ */
+QString FormatDuration(const qint64 argDuration) {
+  if (argDuration < 0) {
+    return QString{"-"};
+  }
+  return QString::number(static_cast<double>(argDuration) / 1000.0, 'f', 1) +
+         " s";
+}
+
+/*!
+ * \brief Return the median of the given sorted durations
+ *
+ * \param[in] argSortedDurations The durations in ascending order
+ *
+ * \return The median of the durations
+ */
+qint64 GetMedian(const QVector<qint64> &argSortedDurations) {
+  return argSortedDurations.at(argSortedDurations.size() / 2);
+}
+} // namespace
+
+/*!
+ * \brief Construct a new tracer observing the given clients
+ *
+ * \param[in] argClients The clients whose z-Leaf starts shall be traced
+ * \param[in] argParent The instance's parent QObject
+ */
+lc::ZLeafStartTracer::ZLeafStartTracer(const QVector<Client *> &argClients,
+                                       QObject *const argParent)
+    : QObject{argParent} {
+  clock.start();
+  Observe(argClients);
+}
+
+/*!
+ * \brief Summarize the recorded traces per session
+ *
+ * For every session the distribution of the times until the z-Leaves connected
+ * is given. Clients taking more than twice the median and at least five
+ * seconds longer than it are flagged as outliers.
+ *
+ * \return A human readable report of all traces
+ */
+QString lc::ZLeafStartTracer::CreateReport() const {
+  if (traces.isEmpty()) {
+    return tr("No z-Leaf starts were traced yet.");
+  }
+
+  QMap<int, QVector<const Trace *>> tracesPerSession;
+  for (const auto &trace : traces) {
+    tracesPerSession[trace.sessionPort].append(&trace);
+  }
+
+  QString report;
+  for (auto it = tracesPerSession.cbegin(); it != tracesPerSession.cend();
+       ++it) {
+    QVector<qint64> durations;
+    QStringList notConnected;
+    for (const auto *const trace : it.value()) {
+      if (trace->connected < 0) {
+        notConnected.append(trace->clientName);
+      } else {
+        durations.append(trace->connected);
+      }
+    }
+    std::sort(durations.begin(), durations.end());
+
+    report.append(tr("Session on port %1: %2 z-Leaf start(s), %3 connected\n")
+                      .arg(it.key())
+                      .arg(it.value().size())
+                      .arg(durations.size()));
+    qint64 outlierThreshold = -1;
+    if (!durations.isEmpty()) {
+      const qint64 median = GetMedian(durations);
+      outlierThreshold = qMax(2 * median, median + 5000);
+      report.append(
+          tr("  Time until connected: median %1, 90th percentile %2, "
+             "maximum %3\n")
+              .arg(FormatDuration(median))
+              .arg(FormatDuration(durations.at((durations.size() * 9) / 10)))
+              .arg(FormatDuration(durations.last())));
+    }
+    if (!notConnected.isEmpty()) {
+      report.append(tr("  Not connected: %1\n").arg(notConnected.join(", ")));
+    }
+    for (const auto *const trace : it.value()) {
+      const bool isOutlier =
+          outlierThreshold >= 0 && trace->connected > outlierThreshold;
+      report.append(
+          tr("  %1%2: ssh connected %3, process started %4, connected %5\n")
+              .arg(isOutlier ? QString{"[OUTLIER] "} : QString{})
+              .arg(trace->clientName)
+              .arg(FormatDuration(trace->sshConnected))
+              .arg(FormatDuration(trace->processStarted))
+              .arg(FormatDuration(trace->connected)));
+    }
+    report.append("\n");
+  }
+  return report;
+}
+
+/*!
+ * \brief Trace the z-Leaf starts of the given clients, too
+ *
+ * Clients which are already observed are not connected again.
+ *
+ * \param[in] argClients The clients whose z-Leaf starts shall be traced
+ */
+void lc::ZLeafStartTracer::Observe(const QVector<Client *> &argClients) {
+  for (auto *const client : argClients) {
+    connect(client, &Client::StateChanged, this,
+            &ZLeafStartTracer::GotClientStateChanged, Qt::UniqueConnection);
+    connect(client, &Client::ZLeafStartPhaseReached, this,
+            &ZLeafStartTracer::GotZLeafStartPhaseReached,
+            Qt::UniqueConnection);
+  }
+}
+
+/*!
+ * \brief Complete a client's open trace if its z-Leaf connected to z-Tree
+ *
+ * \param[in] argState The client's new state
+ */
+void lc::ZLeafStartTracer::GotClientStateChanged(
+    const Client::State argState) {
+  if (argState != Client::State::ZLEAF_RUNNING) {
+    return;
+  }
+  const Client *const client = qobject_cast<Client *>(sender());
+  if (!openTraces.contains(client)) {
+    return;
+  }
+
+  Trace &trace = traces[openTraces.take(client)];
+  trace.connected = clock.elapsed() - trace.issued;
+  qDebug() << "z-Leaf on" << trace.clientName << "connected after"
+           << trace.connected << "ms";
+}
+
+/*!
+ * \brief Record the time a z-Leaf start reached the given phase
+ *
+ * \param[in] argPhase The reached phase
+ */
+void lc::ZLeafStartTracer::GotZLeafStartPhaseReached(
+    const Client::ZLeafStartPhase argPhase) {
+  const Client *const client = qobject_cast<Client *>(sender());
+  if (!client) {
+    return;
+  }
+
+  if (argPhase == Client::ZLeafStartPhase::COMMAND_ISSUED) {
+    // Drop the oldest half of the traces if the limit is reached
+    if (traces.size() >= maxTraces) {
+      const int dropped = traces.size() / 2;
+      traces.remove(0, dropped);
+      for (auto it = openTraces.begin(); it != openTraces.end();) {
+        if (it.value() < dropped) {
+          it = openTraces.erase(it);
+        } else {
+          it.value() -= dropped;
+          ++it;
+        }
+      }
+    }
+
+    Trace trace;
+    trace.clientName = client->name;
+    trace.sessionPort = client->GetSessionPort();
+    trace.issued = clock.elapsed();
+    traces.append(trace);
+    openTraces.insert(client, traces.size() - 1);
+    return;
+  }
+
+  if (!openTraces.contains(client)) {
+    return;
+  }
+  Trace &trace = traces[openTraces.value(client)];
+  const qint64 sinceIssued = clock.elapsed() - trace.issued;
+  if (argPhase == Client::ZLeafStartPhase::SSH_CONNECTED) {
+    trace.sshConnected = sinceIssued;
+  } else {
+    trace.processStarted = sinceIssued;
+  }
+}
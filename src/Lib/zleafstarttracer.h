@@ -0,0 +1,83 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ZLEAFSTARTTRACER_H
+#define ZLEAFSTARTTRACER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QVector>
+
+#include "client.h"
+
+namespace lc {
+
+/*!
+ * \brief Traces how long z-Leaf starts take until they connect to z-Tree
+ *
+ * For every z-Leaf start the times at which the start command was issued, the
+ * 'ssh' connection was established, the z-Leaf process was spawned and the
+ * connection to the session's z-Tree was seen are recorded per client. The
+ * traces can be summarized per session, flagging clients which took unusually
+ * long.
+ */
+class ZLeafStartTracer : public QObject {
+  Q_OBJECT
+
+public:
+  //! The recorded phases of a single z-Leaf start
+  struct Trace {
+    //! The name of the client the z-Leaf was started on
+    QString clientName;
+    //! The port of the session the z-Leaf was started for
+    int sessionPort = 0;
+    //! The time the start command was issued (on the tracer's clock)
+    qint64 issued = 0;
+    //! The milliseconds from issuing until the 'ssh' connection (-1 if none)
+    qint64 sshConnected = -1;
+    //! The milliseconds from issuing until the process was spawned (-1 if none)
+    qint64 processStarted = -1;
+    //! The milliseconds from issuing until z-Tree was connected (-1 if none)
+    qint64 connected = -1;
+  };
+
+  explicit ZLeafStartTracer(const QVector<Client *> &argClients,
+                            QObject *argParent = nullptr);
+
+  QString CreateReport() const;
+  void Observe(const QVector<Client *> &argClients);
+
+private slots:
+  void GotClientStateChanged(Client::State argState);
+  void GotZLeafStartPhaseReached(Client::ZLeafStartPhase argPhase);
+
+private:
+  //! The maximum number of traces which are kept
+  const int maxTraces = 2000;
+  //! Indices of the traces of z-Leaf starts which did not yet connect
+  QHash<const Client *, int> openTraces;
+  //! Provides monotonic time stamps for all traces
+  QElapsedTimer clock;
+  //! All recorded traces in the order the starts were issued
+  QVector<Trace> traces;
+};
+
+} // namespace lc
+
+#endif // ZLEAFSTARTTRACER_H
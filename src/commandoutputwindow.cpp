@@ -0,0 +1,204 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "Lib/client.h"
+#include "Lib/commandexecution.h"
+#include "commandoutputwindow.h"
+#include "ui_commandoutputwindow.h"
+
+/*!
+ * \brief Create a new window displaying the output of the given execution
+ *
+ * \param[in] argExecution The execution whose output shall be displayed (the
+ * window takes over its ownership)
+ * \param[in] argParent The instance's parent QObject
+ */
+lc::CommandOutputWindow::CommandOutputWindow(CommandExecution *argExecution,
+                                             QWidget *const argParent)
+    : QWidget{argParent}, execution{argExecution},
+      ui{new Ui::CommandOutputWindow} {
+  ui->setupUi(this);
+  setAttribute(Qt::WA_DeleteOnClose);
+  setWindowTitle(tr("Output of '%1'").arg(execution->GetCommand()));
+  execution->setParent(this);
+
+  // Sorting is suspended while the rows are inserted
+  ui->TWExitCodes->setSortingEnabled(false);
+  ui->TWExitCodes->setRowCount(execution->GetClients().size());
+  int row = 0;
+  for (auto *const client : execution->GetClients()) {
+    ui->TWExitCodes->setItem(row, 0, new QTableWidgetItem{client->name});
+    QTableWidgetItem *const exitCodeItem = new QTableWidgetItem{tr("running")};
+    ui->TWExitCodes->setItem(row, 1, exitCodeItem);
+    exitCodeItems.insert(client, exitCodeItem);
+    ++row;
+  }
+  ui->TWExitCodes->setSortingEnabled(true);
+  ui->TWExitCodes->sortByColumn(0, Qt::AscendingOrder);
+
+  connect(execution, &CommandExecution::AllFinished, this,
+          &CommandOutputWindow::GotAllFinished);
+  connect(execution, &CommandExecution::ClientFinished, this,
+          &CommandOutputWindow::GotClientFinished);
+  connect(execution, &CommandExecution::OutputRead, this,
+          &CommandOutputWindow::GotOutputRead);
+  connect(ui->TWGroupedOutput, &QTreeWidget::currentItemChanged, this,
+          &CommandOutputWindow::GotCurrentGroupChanged);
+
+  UpdateProgress();
+}
+
+/*!
+ * \brief Destroy the CommandOutputWindow instance
+ */
+lc::CommandOutputWindow::~CommandOutputWindow() { delete ui; }
+
+/*!
+ * \brief Append a single line of a client's output to the live view
+ *
+ * \param[in] argClient The client which produced the line
+ * \param[in] argLine The line which shall be appended
+ */
+void lc::CommandOutputWindow::AppendLiveOutputLine(const Client *argClient,
+                                                   const QString &argLine) {
+  ui->PTELiveOutput->appendPlainText(
+      QString{"[" + argClient->name + "] " + argLine});
+}
+
+/*!
+ * \brief Mark the execution as completed
+ */
+void lc::CommandOutputWindow::GotAllFinished() {
+  UpdateProgress();
+  ui->TWOutputViews->setCurrentWidget(ui->TGroupedOutput);
+}
+
+/*!
+ * \brief Record a client's exit code and regroup the outputs
+ *
+ * \param[in] argClient The client the command finished on
+ * \param[in] argExitCode The command's exit code on the client
+ */
+void lc::CommandOutputWindow::GotClientFinished(Client *argClient,
+                                                const int argExitCode) {
+  // Flush output which was not terminated by a newline
+  const QString remainder{partialLines.take(argClient)};
+  if (!remainder.isEmpty()) {
+    AppendLiveOutputLine(argClient, remainder);
+  }
+
+  QTableWidgetItem *const exitCodeItem = exitCodeItems.value(argClient);
+  if (exitCodeItem) {
+    // Store the code as number, so that it sorts numerically
+    exitCodeItem->setData(Qt::DisplayRole, argExitCode);
+    if (argExitCode) {
+      exitCodeItem->setBackground(QBrush(QColor(255, 128, 128, 255)));
+    }
+  }
+
+  ++finishedClients;
+  UpdateProgress();
+  UpdateGroupedOutput();
+}
+
+/*!
+ * \brief Display the full output of the chosen group
+ *
+ * \param[in] argCurrent The chosen group or client item
+ */
+void lc::CommandOutputWindow::GotCurrentGroupChanged(
+    QTreeWidgetItem *argCurrent) {
+  if (!argCurrent) {
+    ui->PTEGroupOutput->clear();
+    return;
+  }
+  if (argCurrent->parent()) {
+    argCurrent = argCurrent->parent();
+  }
+  ui->PTEGroupOutput->setPlainText(argCurrent->data(0, Qt::UserRole).toString());
+}
+
+/*!
+ * \brief Append the complete lines of new output to the live view
+ *
+ * \param[in] argClient The client the output stems from
+ * \param[in] argOutput The output which was read
+ */
+void lc::CommandOutputWindow::GotOutputRead(Client *argClient,
+                                            const QString &argOutput) {
+  QString &buffer = partialLines[argClient];
+  buffer.append(argOutput);
+  int lineEnd = buffer.indexOf('\n');
+  while (lineEnd != -1) {
+    AppendLiveOutputLine(argClient, buffer.left(lineEnd));
+    buffer.remove(0, lineEnd + 1);
+    lineEnd = buffer.indexOf('\n');
+  }
+}
+
+/*!
+ * \brief Rebuild the view grouping the clients by identical output
+ */
+void lc::CommandOutputWindow::UpdateGroupedOutput() {
+  // Collect the finished clients per distinct output, keeping the order in
+  // which the outputs appeared first
+  QStringList outputs;
+  QHash<QString, QStringList> clientsPerOutput;
+  for (auto *const client : execution->GetClients()) {
+    const CommandExecution::Result result{execution->GetResult(client)};
+    if (!result.finished) {
+      continue;
+    }
+    if (!clientsPerOutput.contains(result.output)) {
+      outputs.append(result.output);
+    }
+    clientsPerOutput[result.output].append(client->name);
+  }
+  // Show the largest groups first
+  std::stable_sort(outputs.begin(), outputs.end(),
+                   [&clientsPerOutput](const QString &argA,
+                                       const QString &argB) {
+                     return clientsPerOutput[argA].size() >
+                            clientsPerOutput[argB].size();
+                   });
+
+  ui->TWGroupedOutput->clear();
+  for (const auto &output : outputs) {
+    const QStringList &clientNames = clientsPerOutput[output];
+    QTreeWidgetItem *const groupItem = new QTreeWidgetItem{
+        ui->TWGroupedOutput,
+        QStringList{tr("%1 client(s)").arg(clientNames.size()),
+                    output.section('\n', 0, 0)}};
+    groupItem->setData(0, Qt::UserRole, output);
+    for (const auto &name : clientNames) {
+      new QTreeWidgetItem{groupItem, QStringList{name}};
+    }
+  }
+}
+
+/*!
+ * \brief Display how many clients already finished the command
+ */
+void lc::CommandOutputWindow::UpdateProgress() {
+  ui->LProgress->setText(tr("Finished on %1 of %2 clients")
+                             .arg(finishedClients)
+                             .arg(execution->GetClients().size()));
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMMANDOUTPUTWINDOW_H
+#define COMMANDOUTPUTWINDOW_H
+
+#include <QHash>
+#include <QWidget>
+
+class QTableWidgetItem;
+class QTreeWidgetItem;
+
+namespace lc {
+
+class Client;
+class CommandExecution;
+
+namespace Ui {
+class CommandOutputWindow;
+} // namespace Ui
+
+/*!
+ * \brief Displays the aggregated output of a command executed on many clients
+ *
+ * The output of all clients is streamed into one live view. Clients which
+ * produced identical output are grouped and the exit codes are summarized in a
+ * table sortable by client or exit code.
+ */
+class CommandOutputWindow : public QWidget {
+  Q_OBJECT
+
+public:
+  explicit CommandOutputWindow(CommandExecution *argExecution,
+                               QWidget *argParent = nullptr);
+  ~CommandOutputWindow() override;
+
+private slots:
+  void GotAllFinished();
+  void GotClientFinished(lc::Client *argClient, int argExitCode);
+  void GotCurrentGroupChanged(QTreeWidgetItem *argCurrent);
+  void GotOutputRead(lc::Client *argClient, const QString &argOutput);
+
+private:
+  void AppendLiveOutputLine(const Client *argClient, const QString &argLine);
+  void UpdateGroupedOutput();
+  void UpdateProgress();
+
+  //! The exit code cells of the summary table per client
+  QHash<Client *, QTableWidgetItem *> exitCodeItems;
+  //! The execution whose output is displayed
+  CommandExecution *const execution = nullptr;
+  //! The number of clients the command already finished on
+  int finishedClients = 0;
+  //! Output of the clients which does not yet form a complete line
+  QHash<Client *, QString> partialLines;
+  Ui::CommandOutputWindow *const ui = nullptr;
+};
+
+} // namespace lc
+
+#endif // COMMANDOUTPUTWINDOW_H
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QDateTime>
+
+#include "Lib/client.h"
+#include "helprequestspanel.h"
+#include "ui_helprequestspanel.h"
+
+namespace {
+//! The columns of the help requests list
+enum Column { CLIENT, ADDRESS, FIRST_REQUEST, LATEST_REQUEST, REQUESTS };
+} // namespace
+
+/*!
+ * \brief Create a new, empty help requests panel
+ *
+ * \param[in] argParent The instance's parent widget
+ */
+lc::HelpRequestsPanel::HelpRequestsPanel(QWidget *const argParent)
+    : QWidget{argParent}, ui{new Ui::HelpRequestsPanel} {
+  ui->setupUi(this);
+}
+
+/*!
+ * \brief Destroy the HelpRequestsPanel instance
+ */
+lc::HelpRequestsPanel::~HelpRequestsPanel() { delete ui; }
+
+/*!
+ * \brief Acknowledge a single request and remove it from the list
+ *
+ * \param[in] argItem The list entry of the request
+ */
+void lc::HelpRequestsPanel::Acknowledge(QTreeWidgetItem *const argItem) {
+  const QString peerAddress = argItem->text(ADDRESS);
+  requestItems.remove(peerAddress);
+  Client *const client = requestingClients.take(peerAddress);
+  delete argItem;
+  if (client) {
+    emit HelpRequestStateChanged(client, false);
+  }
+}
+
+/*!
+ * \brief Queue a help request or update the entry of a repeated one
+ *
+ * \param[in] argPeerAddress The IP address the request was sent from
+ * \param[in] argClient The requesting client or 'nullptr' if it is unknown
+ */
+void lc::HelpRequestsPanel::AddHelpRequest(const QString &argPeerAddress,
+                                           Client *const argClient) {
+  const QString now = QDateTime::currentDateTime().toString("hh:mm:ss");
+
+  QTreeWidgetItem *item = requestItems.value(argPeerAddress);
+  if (item) {
+    // Repeated requests only update the existing entry
+    item->setText(LATEST_REQUEST, now);
+    item->setData(REQUESTS, Qt::DisplayRole,
+                  item->data(REQUESTS, Qt::DisplayRole).toInt() + 1);
+    ui->TWHelpRequests->takeTopLevelItem(
+        ui->TWHelpRequests->indexOfTopLevelItem(item));
+  } else {
+    item = new QTreeWidgetItem{QStringList{
+        argClient ? argClient->name : tr("unknown client"), argPeerAddress,
+        now, now}};
+    item->setData(REQUESTS, Qt::DisplayRole, 1);
+    requestItems.insert(argPeerAddress, item);
+    if (argClient) {
+      requestingClients.insert(argPeerAddress, argClient);
+      emit HelpRequestStateChanged(argClient, true);
+    }
+  }
+  // The most recent requests are listed first
+  ui->TWHelpRequests->insertTopLevelItem(0, item);
+}
+
+void lc::HelpRequestsPanel::on_PBAcknowledge_clicked() {
+  for (auto *const item : ui->TWHelpRequests->selectedItems()) {
+    Acknowledge(item);
+  }
+}
+
+void lc::HelpRequestsPanel::on_PBAcknowledgeAll_clicked() {
+  while (ui->TWHelpRequests->topLevelItemCount()) {
+    Acknowledge(ui->TWHelpRequests->topLevelItem(0));
+  }
+}
+
+void lc::HelpRequestsPanel::on_TWHelpRequests_itemDoubleClicked(
+    QTreeWidgetItem *const argItem) {
+  const Client *const client =
+      requestingClients.value(argItem->text(ADDRESS), nullptr);
+  if (client) {
+    emit ShowClientRequested(client);
+  }
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HELPREQUESTSPANEL_H
+#define HELPREQUESTSPANEL_H
+
+#include <QHash>
+#include <QWidget>
+
+class QTreeWidgetItem;
+
+namespace lc {
+
+class Client;
+
+namespace Ui {
+class HelpRequestsPanel;
+} // namespace Ui
+
+/*!
+ * \brief Lists the open help requests of the clients
+ *
+ * Every requesting client is listed once with the times of its first and
+ * latest request and the number of requests. Entries stay until they are
+ * acknowledged by the experimenter, which never blocks the event loop.
+ */
+class HelpRequestsPanel : public QWidget {
+  Q_OBJECT
+
+public:
+  explicit HelpRequestsPanel(QWidget *argParent = nullptr);
+  ~HelpRequestsPanel() override;
+
+  //! Returns the number of clients with open help requests
+  int GetOpenRequestsCount() const { return requestItems.size(); }
+
+public slots:
+  void AddHelpRequest(const QString &argPeerAddress, lc::Client *argClient);
+
+signals:
+  /*!
+   * \brief Emitted if a client's help request was opened or acknowledged
+   *
+   * \param argClient The client whose request state changed
+   * \param argOpen 'true' if the client has an open request, 'false' otherwise
+   */
+  void HelpRequestStateChanged(const lc::Client *argClient, bool argOpen);
+  /*!
+   * \brief Emitted if the experimenter wants to see a client on the map
+   *
+   * \param argClient The client which shall be shown
+   */
+  void ShowClientRequested(const lc::Client *argClient);
+
+private slots:
+  void on_PBAcknowledge_clicked();
+  void on_PBAcknowledgeAll_clicked();
+  void on_TWHelpRequests_itemDoubleClicked(QTreeWidgetItem *argItem);
+
+private:
+  void Acknowledge(QTreeWidgetItem *argItem);
+
+  //! The list entries of the open requests per peer address
+  QHash<QString, QTreeWidgetItem *> requestItems;
+  //! The known clients with open requests per peer address
+  QHash<QString, Client *> requestingClients;
+  Ui::HelpRequestsPanel *const ui = nullptr;
+};
+
+} // namespace lc
+
+#endif // HELPREQUESTSPANEL_H
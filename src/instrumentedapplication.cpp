@@ -0,0 +1,71 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QElapsedTimer>
+#include <QPointer>
+
+#include "Lib/instrumentation.h"
+#include "instrumentedapplication.h"
+
+lc::InstrumentedApplication::InstrumentedApplication(int &argc, char **argv)
+    : QApplication{argc, argv} {}
+
+/*!
+ * \brief Deliver the event and measure the time this takes if instrumentation
+ * is activated
+ *
+ * \param[in] argReceiver The receiver of the event
+ * \param[in] argEvent The event to be delivered
+ *
+ * \return The value returned by the receiver's event handling
+ */
+bool lc::InstrumentedApplication::notify(QObject *const argReceiver,
+                                         QEvent *const argEvent) {
+  if (!instrumentation) {
+    return QApplication::notify(argReceiver, argEvent);
+  }
+
+  const QEvent::Type eventType = argEvent->type();
+  if (eventType != QEvent::KeyRelease &&
+      eventType != QEvent::MouseButtonRelease && eventType != QEvent::Timer) {
+    return QApplication::notify(argReceiver, argEvent);
+  }
+  // The receiver may be destroyed by the handling of the event
+  const QPointer<QObject> receiver{argReceiver};
+  QElapsedTimer deliveryTimer;
+  deliveryTimer.start();
+  const bool result = QApplication::notify(argReceiver, argEvent);
+  if (receiver) {
+    instrumentation->RecordEventDelivery(receiver, eventType,
+                                         deliveryTimer.nsecsElapsed());
+  }
+  return result;
+}
+
+/*!
+ * \brief Activate instrumentation by reporting to the given instance
+ *
+ * \param[in] argInstrumentation The instance receiving the measurements (the
+ * application takes over its ownership)
+ */
+void lc::InstrumentedApplication::SetInstrumentation(
+    Instrumentation *const argInstrumentation) {
+  instrumentation = argInstrumentation;
+  instrumentation->setParent(this);
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INSTRUMENTEDAPPLICATION_H
+#define INSTRUMENTEDAPPLICATION_H
+
+#include <QApplication>
+
+namespace lc {
+
+class Instrumentation;
+
+/*!
+ * \brief An application reporting the delivery times of all events to an
+ * optional Instrumentation instance
+ */
+class InstrumentedApplication : public QApplication {
+  Q_OBJECT
+
+public:
+  InstrumentedApplication(int &argc, char **argv);
+
+  //! Returns the active instrumentation ('nullptr' if deactivated)
+  Instrumentation *GetInstrumentation() const { return instrumentation; }
+  bool notify(QObject *argReceiver, QEvent *argEvent) override;
+  void SetInstrumentation(Instrumentation *argInstrumentation);
+
+private:
+  //! Receives the measured delivery times if instrumentation is activated
+  Instrumentation *instrumentation = nullptr;
+};
+
+} // namespace lc
+
+#endif // INSTRUMENTEDAPPLICATION_H
@@ -0,0 +1,434 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QWheelEvent>
+
+#include "labmapview.h"
+
+namespace {
+//! The margin between a cell's border and its icon and text in pixels
+const int cellMargin = 3;
+//! The smallest zoom factor which can be chosen
+const double minimumZoom = 0.25;
+//! The largest zoom factor which can be chosen
+const double maximumZoom = 3.0;
+//! The factor the zoom is changed with per step
+const double zoomStep = 1.25;
+} // namespace
+
+/*!
+ * \brief Construct a new, empty lab map
+ *
+ * \param[in] argParent The instance's parent widget
+ */
+lc::LabMapView::LabMapView(QWidget *const argParent)
+    : QAbstractScrollArea{argParent} {
+  setFocusPolicy(Qt::StrongFocus);
+  viewport()->setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+/*!
+ * \brief Show the clients of the given model and share the given selection
+ *
+ * \param[in] argModel The model holding the clients of all rooms
+ * \param[in] argSelectionModel The selection model operating on 'argModel'
+ */
+void lc::LabMapView::SetModel(ClientsGridModel *const argModel,
+                              QItemSelectionModel *const argSelectionModel) {
+  model = argModel;
+  selectionModel = argSelectionModel;
+  connect(model, &ClientsGridModel::dataChanged, this,
+          &LabMapView::GotDataChanged);
+  connect(model, &ClientsGridModel::modelReset, this, [this]() {
+    glyphs.clear();
+    room = -1;
+    SetRoom(0);
+  });
+  connect(selectionModel, &QItemSelectionModel::selectionChanged, this,
+          &LabMapView::GotSelectionChanged);
+  SetRoom(0);
+}
+
+/*!
+ * \brief Highlight or unhighlight a client with an open help request
+ *
+ * \param[in] argClient The client whose help request state changed
+ * \param[in] argRequested 'true' if the client has an open help request
+ */
+void lc::LabMapView::SetHelpRequested(const Client *const argClient,
+                                      const bool argRequested) {
+  if (argRequested) {
+    helpRequestingClients.insert(argClient);
+  } else {
+    helpRequestingClients.remove(argClient);
+  }
+  if (model) {
+    const QModelIndex cell = model->GetIndex(argClient);
+    if (cell.isValid()) {
+      UpdateCells(QItemSelection{cell, cell});
+    }
+  }
+}
+
+/*!
+ * \brief Show the clients of the given room
+ *
+ * \param[in] argRoom The index of the room in the model's rooms
+ */
+void lc::LabMapView::SetRoom(const int argRoom) {
+  if (!model || argRoom == room) {
+    return;
+  }
+  room = argRoom;
+  roomArea = model->GetRoomArea(argRoom);
+  anchor = QModelIndex{};
+  horizontalScrollBar()->setValue(0);
+  verticalScrollBar()->setValue(0);
+  UpdateScrollBars();
+  viewport()->update();
+}
+
+/*!
+ * \brief Switch to the client's room and scroll its cell into view
+ *
+ * \param[in] argClient The client which shall be shown
+ */
+void lc::LabMapView::ShowClient(const Client *const argClient) {
+  if (!model) {
+    return;
+  }
+  const int clientRoom = model->GetRooms().indexOf(argClient->room);
+  if (clientRoom != room) {
+    SetRoom(clientRoom);
+    emit RoomShown(clientRoom);
+  }
+  const QModelIndex cell = model->GetIndex(argClient);
+  if (!cell.isValid()) {
+    return;
+  }
+  const QRect cellRect = GetCellRect(cell.row(), cell.column());
+  if (!viewport()->rect().contains(cellRect)) {
+    horizontalScrollBar()->setValue(horizontalScrollBar()->value() +
+                                    cellRect.center().x() -
+                                    viewport()->width() / 2);
+    verticalScrollBar()->setValue(verticalScrollBar()->value() +
+                                  cellRect.center().y() -
+                                  viewport()->height() / 2);
+  }
+}
+
+void lc::LabMapView::ZoomIn() { SetZoom(zoom * zoomStep); }
+
+void lc::LabMapView::ZoomOut() { SetZoom(zoom / zoomStep); }
+
+/*!
+ * \brief Return the cell of the current room at the given viewport position
+ *
+ * \param[in] argPosition The position in viewport coordinates
+ *
+ * \return The cell's index or an invalid index if there is no cell
+ */
+QModelIndex lc::LabMapView::GetCellAt(const QPoint &argPosition) const {
+  if (!model) {
+    return QModelIndex{};
+  }
+  const int x = argPosition.x() + horizontalScrollBar()->value();
+  const int y = argPosition.y() + verticalScrollBar()->value();
+  const int cellWidth = qRound(baseCellWidth * zoom);
+  const int cellHeight = qRound(baseCellHeight * zoom);
+  if (x < 0 || y < 0 || x >= roomArea.width() * cellWidth ||
+      y >= roomArea.height() * cellHeight) {
+    return QModelIndex{};
+  }
+  return model->index(y / cellHeight, roomArea.left() + x / cellWidth);
+}
+
+/*!
+ * \brief Return the rectangle a cell of the grid occupies in the viewport
+ *
+ * \param[in] argRow The cell's row in the model's grid
+ * \param[in] argColumn The cell's column in the model's grid
+ *
+ * \return The cell's rectangle in viewport coordinates
+ */
+QRect lc::LabMapView::GetCellRect(const int argRow, const int argColumn) const {
+  const int cellWidth = qRound(baseCellWidth * zoom);
+  const int cellHeight = qRound(baseCellHeight * zoom);
+  return QRect{(argColumn - roomArea.left()) * cellWidth -
+                   horizontalScrollBar()->value(),
+               argRow * cellHeight - verticalScrollBar()->value(), cellWidth,
+               cellHeight};
+}
+
+/*!
+ * \brief Return the glyph of the state of the given cell's client
+ *
+ * Glyphs consist of the state's background and icon and are rendered once per
+ * state and zoom level.
+ *
+ * \param[in] argIndex The cell whose glyph shall be returned
+ *
+ * \return The glyph at the current zoom level
+ */
+const QPixmap &lc::LabMapView::GetGlyph(const QModelIndex &argIndex) {
+  const int state = argIndex.data(ClientsGridModel::StateRole).toInt();
+  auto it = glyphs.find(state);
+  if (it != glyphs.end()) {
+    return it.value();
+  }
+
+  const QSize cellSize{qRound(baseCellWidth * zoom),
+                       qRound(baseCellHeight * zoom)};
+  QPixmap glyph{cellSize};
+  glyph.fill(argIndex.data(Qt::BackgroundRole).value<QBrush>().color());
+  const QPixmap icon = argIndex.data(Qt::DecorationRole).value<QPixmap>();
+  if (!icon.isNull()) {
+    const int iconSize = cellSize.height() - 2 * cellMargin;
+    QPainter painter{&glyph};
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.drawPixmap(QRect{cellMargin, cellMargin, iconSize, iconSize}, icon);
+  }
+  return glyphs.insert(state, glyph).value();
+}
+
+void lc::LabMapView::keyPressEvent(QKeyEvent *const argEvent) {
+  if (argEvent->matches(QKeySequence::ZoomIn)) {
+    ZoomIn();
+  } else if (argEvent->matches(QKeySequence::ZoomOut)) {
+    ZoomOut();
+  } else if (argEvent->matches(QKeySequence::SelectAll) && selectionModel &&
+             roomArea.isValid()) {
+    selectionModel->select(
+        QItemSelection{
+            model->index(roomArea.top(), roomArea.left()),
+            model->index(roomArea.bottom(), roomArea.right())},
+        QItemSelectionModel::ClearAndSelect);
+  } else {
+    QAbstractScrollArea::keyPressEvent(argEvent);
+  }
+}
+
+void lc::LabMapView::mouseMoveEvent(QMouseEvent *const argEvent) {
+  if (!(argEvent->buttons() & Qt::LeftButton) || !anchor.isValid()) {
+    return;
+  }
+  const QModelIndex cell = GetCellAt(argEvent->pos());
+  if (cell.isValid()) {
+    SelectUpTo(cell);
+  }
+}
+
+void lc::LabMapView::mousePressEvent(QMouseEvent *const argEvent) {
+  if (!selectionModel || argEvent->button() != Qt::LeftButton) {
+    return;
+  }
+  const QModelIndex cell = GetCellAt(argEvent->pos());
+  if (!cell.isValid()) {
+    if (!(argEvent->modifiers() & Qt::ControlModifier)) {
+      selectionModel->clearSelection();
+    }
+    anchor = QModelIndex{};
+    return;
+  }
+
+  if (argEvent->modifiers() & Qt::ShiftModifier && anchor.isValid()) {
+    SelectUpTo(cell);
+    return;
+  }
+  selectionModel->select(cell, argEvent->modifiers() & Qt::ControlModifier
+                                   ? QItemSelectionModel::Toggle
+                                   : QItemSelectionModel::ClearAndSelect);
+  anchor = cell;
+}
+
+void lc::LabMapView::paintEvent(QPaintEvent *const argEvent) {
+  QPainter painter{viewport()};
+  const QRect dirtyRect = argEvent->rect();
+  painter.fillRect(dirtyRect, palette().base());
+  if (!model || !roomArea.isValid()) {
+    return;
+  }
+
+  // Determine the range of cells intersecting the area to be repainted
+  const int cellWidth = qRound(baseCellWidth * zoom);
+  const int cellHeight = qRound(baseCellHeight * zoom);
+  const int firstColumn = qMax(
+      0, (dirtyRect.left() + horizontalScrollBar()->value()) / cellWidth);
+  const int lastColumn = qMin(
+      roomArea.width() - 1,
+      (dirtyRect.right() + horizontalScrollBar()->value()) / cellWidth);
+  const int firstRow =
+      qMax(0, (dirtyRect.top() + verticalScrollBar()->value()) / cellHeight);
+  const int lastRow =
+      qMin(roomArea.height() - 1,
+           (dirtyRect.bottom() + verticalScrollBar()->value()) / cellHeight);
+
+  QFont cellFont = font();
+  cellFont.setPointSizeF(qMax(1.0, font().pointSizeF() * zoom));
+  painter.setFont(cellFont);
+  const QPen gridPen{palette().mid().color()};
+  const QPen selectionPen{palette().highlight().color(), 3.0};
+  const QPen helpRequestPen{QColor{255, 128, 0, 255}, 5.0, Qt::DashLine};
+  const int textOffset = cellHeight;
+
+  for (int row = firstRow; row <= lastRow; ++row) {
+    for (int column = roomArea.left() + firstColumn;
+         column <= roomArea.left() + lastColumn; ++column) {
+      const QModelIndex cell = model->index(row, column);
+      const QRect cellRect = GetCellRect(row, column);
+      const Client *const client = model->GetClient(cell);
+      if (client) {
+        painter.drawPixmap(cellRect.topLeft(), GetGlyph(cell));
+        painter.setPen(palette().text().color());
+        const QRect textRect =
+            cellRect.adjusted(textOffset, 0, -cellMargin, 0);
+        painter.drawText(textRect, Qt::AlignLeft | Qt::AlignVCenter,
+                         painter.fontMetrics().elidedText(
+                             client->name, Qt::ElideRight, textRect.width()));
+      }
+      painter.setPen(gridPen);
+      painter.drawRect(cellRect.adjusted(0, 0, -1, -1));
+      if (client && helpRequestingClients.contains(client)) {
+        painter.setPen(helpRequestPen);
+        painter.drawRect(cellRect.adjusted(2, 2, -3, -3));
+      }
+      if (client && selectionModel->isSelected(cell)) {
+        painter.setPen(selectionPen);
+        painter.drawRect(cellRect.adjusted(1, 1, -2, -2));
+      }
+    }
+  }
+}
+
+void lc::LabMapView::resizeEvent(QResizeEvent *const argEvent) {
+  QAbstractScrollArea::resizeEvent(argEvent);
+  UpdateScrollBars();
+}
+
+/*!
+ * \brief Select all cells in the rectangle between the anchor and the given
+ * cell
+ *
+ * \param[in] argIndex The cell opposite of the anchor
+ */
+void lc::LabMapView::SelectUpTo(const QModelIndex &argIndex) {
+  selectionModel->select(
+      QItemSelection{
+          model->index(qMin(anchor.row(), argIndex.row()),
+                       qMin(anchor.column(), argIndex.column())),
+          model->index(qMax(anchor.row(), argIndex.row()),
+                       qMax(anchor.column(), argIndex.column()))},
+      QItemSelectionModel::ClearAndSelect);
+}
+
+/*!
+ * \brief Change the zoom factor and drop all glyphs of the previous one
+ *
+ * \param[in] argZoom The new zoom factor
+ */
+void lc::LabMapView::SetZoom(const double argZoom) {
+  const double newZoom = qBound(minimumZoom, argZoom, maximumZoom);
+  if (qFuzzyCompare(newZoom, zoom)) {
+    return;
+  }
+  zoom = newZoom;
+  glyphs.clear();
+  UpdateScrollBars();
+  viewport()->update();
+}
+
+/*!
+ * \brief Schedule the repaint of the visible ones of the given cells
+ *
+ * \param[in] argCells The cells which shall be repainted
+ */
+void lc::LabMapView::UpdateCells(const QItemSelection &argCells) {
+  const QRect visibleRect = viewport()->rect();
+  for (const auto &range : argCells) {
+    const int left = qMax(range.left(), roomArea.left());
+    const int right = qMin(range.right(), roomArea.right());
+    if (left > right) {
+      continue;
+    }
+    const QRect rangeRect = GetCellRect(range.top(), left)
+                                .united(GetCellRect(range.bottom(), right));
+    if (rangeRect.intersects(visibleRect)) {
+      viewport()->update(rangeRect.intersected(visibleRect));
+    }
+  }
+}
+
+/*!
+ * \brief Adapt the scroll bars' ranges to the room's size at the current zoom
+ */
+void lc::LabMapView::UpdateScrollBars() {
+  const int cellWidth = qRound(baseCellWidth * zoom);
+  const int cellHeight = qRound(baseCellHeight * zoom);
+  const QSize viewportSize = viewport()->size();
+
+  horizontalScrollBar()->setRange(
+      0, qMax(0, roomArea.width() * cellWidth - viewportSize.width()));
+  horizontalScrollBar()->setPageStep(viewportSize.width());
+  horizontalScrollBar()->setSingleStep(cellWidth);
+  verticalScrollBar()->setRange(
+      0, qMax(0, roomArea.height() * cellHeight - viewportSize.height()));
+  verticalScrollBar()->setPageStep(viewportSize.height());
+  verticalScrollBar()->setSingleStep(cellHeight);
+}
+
+void lc::LabMapView::wheelEvent(QWheelEvent *const argEvent) {
+  if (!(argEvent->modifiers() & Qt::ControlModifier)) {
+    QAbstractScrollArea::wheelEvent(argEvent);
+    return;
+  }
+  if (argEvent->angleDelta().y() > 0) {
+    ZoomIn();
+  } else if (argEvent->angleDelta().y() < 0) {
+    ZoomOut();
+  }
+  argEvent->accept();
+}
+
+/*!
+ * \brief Repaint the cells whose clients changed
+ *
+ * \param[in] argTopLeft The top left cell of the changed area
+ * \param[in] argBottomRight The bottom right cell of the changed area
+ */
+void lc::LabMapView::GotDataChanged(const QModelIndex &argTopLeft,
+                                    const QModelIndex &argBottomRight) {
+  UpdateCells(QItemSelection{argTopLeft, argBottomRight});
+}
+
+/*!
+ * \brief Repaint the cells whose selection state changed
+ *
+ * \param[in] argSelected The newly selected cells
+ * \param[in] argDeselected The newly deselected cells
+ */
+void lc::LabMapView::GotSelectionChanged(const QItemSelection &argSelected,
+                                         const QItemSelection &argDeselected) {
+  UpdateCells(argSelected);
+  UpdateCells(argDeselected);
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LABMAPVIEW_H
+#define LABMAPVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QHash>
+#include <QItemSelectionModel>
+#include <QPixmap>
+#include <QSet>
+
+#include "Lib/clientsgridmodel.h"
+
+namespace lc {
+
+/*!
+ * \brief Paints the clients of one room of the lab as a zoomable map
+ *
+ * Only the cells within the visible part of the room are painted. The
+ * background and icon of every client state are rendered into a cached glyph
+ * once per zoom level. Cells are only repainted if the model announces a
+ * change of their client or their selection state changes. Clients with open
+ * help requests are highlighted.
+ */
+class LabMapView : public QAbstractScrollArea {
+  Q_OBJECT
+
+public:
+  explicit LabMapView(QWidget *argParent = nullptr);
+
+  void SetModel(ClientsGridModel *argModel,
+                QItemSelectionModel *argSelectionModel);
+
+public slots:
+  void SetHelpRequested(const lc::Client *argClient, bool argRequested);
+  void SetRoom(int argRoom);
+  void ShowClient(const lc::Client *argClient);
+  void ZoomIn();
+  void ZoomOut();
+
+signals:
+  /*!
+   * \brief Emitted if the view switched to another room on its own
+   *
+   * \param argRoom The index of the shown room in the model's rooms
+   */
+  void RoomShown(int argRoom);
+
+protected:
+  void keyPressEvent(QKeyEvent *argEvent) override;
+  void mouseMoveEvent(QMouseEvent *argEvent) override;
+  void mousePressEvent(QMouseEvent *argEvent) override;
+  void paintEvent(QPaintEvent *argEvent) override;
+  void resizeEvent(QResizeEvent *argEvent) override;
+  void wheelEvent(QWheelEvent *argEvent) override;
+
+private slots:
+  void GotDataChanged(const QModelIndex &argTopLeft,
+                      const QModelIndex &argBottomRight);
+  void GotSelectionChanged(const QItemSelection &argSelected,
+                           const QItemSelection &argDeselected);
+
+private:
+  QModelIndex GetCellAt(const QPoint &argPosition) const;
+  QRect GetCellRect(int argRow, int argColumn) const;
+  const QPixmap &GetGlyph(const QModelIndex &argIndex);
+  void SelectUpTo(const QModelIndex &argIndex);
+  void SetZoom(double argZoom);
+  void UpdateCells(const QItemSelection &argCells);
+  void UpdateScrollBars();
+
+  //! The cell the current mouse selection started at
+  QPersistentModelIndex anchor;
+  //! The unscaled height of a cell in pixels
+  const int baseCellHeight = 35;
+  //! The unscaled width of a cell in pixels
+  const int baseCellWidth = 115;
+  //! The glyphs of all client states rendered at the current zoom level
+  QHash<int, QPixmap> glyphs;
+  //! The clients with open help requests
+  QSet<const Client *> helpRequestingClients;
+  //! The model holding the clients of all rooms
+  ClientsGridModel *model = nullptr;
+  //! The index of the currently shown room
+  int room = -1;
+  //! The area of the currently shown room in the model's grid
+  QRect roomArea;
+  //! The selection model shared with the selection tracking
+  QItemSelectionModel *selectionModel = nullptr;
+  //! The factor the cells are scaled with
+  double zoom = 1.0;
+};
+
+} // namespace lc
+
+#endif // LABMAPVIEW_H
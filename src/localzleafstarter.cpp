@@ -41,8 +41,8 @@ lc::LocalzLeafStarter::LocalzLeafStarter(QWidget *const argParent)
   ui->LELocalzLeafSize->setText(settings->GetLocalzLeafSize());
 
   ui->CBzLeafVersion->addItem(tr("Please choose a version"));
-  if (!settings->installedZTreeVersions.isEmpty()) {
-    ui->CBzLeafVersion->addItems(settings->installedZTreeVersions);
+  if (!settings->GetInstalledZTreeVersions().isEmpty()) {
+    ui->CBzLeafVersion->addItems(settings->GetInstalledZTreeVersions());
   }
 }
 
@@ -19,23 +19,39 @@
 
 #include <memory>
 
-#include <QApplication>
-
+#include "Lib/instrumentation.h"
+#include "Lib/receiptsjournal.h"
+#include "Lib/receiptsscheduler.h"
 #include "Lib/settings.h"
+#include "Lib/startupprofiler.h"
+#include "instrumentedapplication.h"
 #include "mainwindow.h"
 
+std::unique_ptr<lc::ReceiptsJournal> receiptsJournal;
+std::unique_ptr<lc::ReceiptsScheduler> receiptsScheduler;
 std::unique_ptr<lc::Settings> settings;
+std::unique_ptr<lc::StartupProfiler> startupProfiler;
 
 int main(int argc, char *argv[]) {
-  QApplication a{argc, argv};
+  startupProfiler.reset(new lc::StartupProfiler);
+  lc::InstrumentedApplication a{argc, argv};
+  startupProfiler->Mark("Application creation");
 
   qRegisterMetaType<lc::Client::State>();
   qRegisterMetaType<lc::Client::State>("Client::State");
   qRegisterMetaType<lc::Client::State>("lc::Client::State");
 
   settings.reset(new lc::Settings{QSettings{"Labcontrol", "Labcontrol"}});
+  startupProfiler->Mark("Reading the settings");
+  receiptsJournal.reset(new lc::ReceiptsJournal{settings->receiptsJournalFile});
+  receiptsScheduler.reset(new lc::ReceiptsScheduler);
+  if (settings->instrumentationEnabled) {
+    a.SetInstrumentation(
+        new lc::Instrumentation{settings->instrumentationLogFile});
+  }
   lc::MainWindow w;
   w.show();
+  startupProfiler->Mark("Showing the main window");
 
   return a.exec();
 }
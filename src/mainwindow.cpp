@@ -19,38 +19,52 @@
 
 #include <memory>
 
+#include "Lib/commandexecution.h"
+#include "Lib/instrumentation.h"
+#include "Lib/receiptsjournal.h"
+#include "Lib/sessionstarter.h"
 #include "Lib/settings.h"
+#include "Lib/startupprofiler.h"
+#include "commandoutputwindow.h"
+#include "helprequestspanel.h"
+#include "instrumentedapplication.h"
+#include "labmapview.h"
 #include "localzleafstarter.h"
 #include "mainwindow.h"
 #include "manualprintingsetup.h"
+#include "thumbnailwall.h"
+#include <QApplication>
 #include <QButtonGroup>
 #include <QDebug>
+#include <QDockWidget>
 #include <QInputDialog>
+#include <QProgressBar>
+#include <QTabBar>
 #include <QtGlobal>
 
+extern std::unique_ptr<lc::ReceiptsJournal> receiptsJournal;
 extern std::unique_ptr<lc::Settings> settings;
+extern std::unique_ptr<lc::StartupProfiler> startupProfiler;
 
 lc::MainWindow::MainWindow(QWidget *argParent)
     : QMainWindow{argParent},
       icons(static_cast<int>(icons_t::ICON_QUANTITY)), ui{new Ui::MainWindow} {
   ui->setupUi(this);
+  startupProfiler->Mark("Setting up the user interface");
   lablib = new Lablib{this};
+  startupProfiler->Mark("Creating the lab");
 
   LoadIconPixmaps();
+  startupProfiler->Mark("Loading the icons");
 
   SetupWidgets();
-  if (valid_items) {
-    gui_update_timer = new QTimer{this};
-    connect(gui_update_timer, &QTimer::timeout, this,
-            &MainWindow::UpdateClientsTableView);
-    gui_update_timer->start(500);
-  }
+  SetupDiagnosticsTab();
+  startupProfiler->Mark("Setting up the widgets");
 
   /* session actions */
 
-  // Add z-Tree versions to the corresponding combo box
+  // The installed z-Tree versions are added once they were detected
   ui->CBzTreeVersion->addItem(tr("Please choose a version:"));
-  ui->CBzTreeVersion->addItems(settings->installedZTreeVersions);
 
   // Add default path to the corresponding combo box
   ui->CBDataTargetPath->addItem(tr("Set a new path HERE"));
@@ -60,40 +74,26 @@ lc::MainWindow::MainWindow(QWidget *argParent)
   connect(this, &MainWindow::RequestNewDataTargetPath, this,
           &MainWindow::GetNewDataTargetPath);
 
-  if (settings->dvipsCmd.isEmpty() || settings->latexCmd.isEmpty() ||
-      settings->lcDataDir.isEmpty() || settings->lprCmd.isEmpty() ||
-      settings->postscriptViewer.isEmpty() || settings->ps2pdfCmd.isEmpty() ||
-      settings->rmCmd.isEmpty() || settings->vncViewer.isEmpty()) {
-    QMessageBox::information(
-        this, tr("Receipts printing will not work"),
-        tr("Some component essential for receipts creation and"
-           " printing is missing. No receipts will be created or"
-           " printed."),
-        QMessageBox::Ok);
-  } else {
-    ui->CBReceiptsHeader->addItems(settings->installedLaTeXHeaders);
+  // Everything not needed for the first frame is done after it was shown
+  connect(settings.get(), &Settings::DeferredChecksFinished, this,
+          &MainWindow::GotDeferredChecksFinished);
+  QTimer::singleShot(0, this, &MainWindow::StartDeferredInitialization);
 
-    if (settings->defaultReceiptIndex &&
-        settings->defaultReceiptIndex < ui->CBReceiptsHeader->count()) {
-      ui->CBReceiptsHeader->setCurrentIndex(settings->defaultReceiptIndex);
-    }
-  }
+  connect(lablib->GetSettingsReloader(), &SettingsReloader::SettingsReloaded,
+          this, &MainWindow::GotSettingsReloaded);
 }
 
 lc::MainWindow::~MainWindow() {
   delete ui;
-  delete valid_items;
 }
 
 bool lc::MainWindow::CheckIfUserIsAdmin() {
   if (settings->localUserName.isEmpty()) {
-    QMessageBox messageBox{
-        QMessageBox::Warning, tr("User not detectable"),
+    ShowInformation(
+        tr("User not detectable"),
         tr("Your user name could not be queryed. The admin tab will be"
            " disabled. You won't be able to perform administrative"
-           " actions but can conduct experiments normally."),
-        QMessageBox::Ok};
-    messageBox.exec();
+           " actions but can conduct experiments normally."));
     return false;
   }
 
@@ -103,7 +103,7 @@ bool lc::MainWindow::CheckIfUserIsAdmin() {
 }
 
 void lc::MainWindow::DisableDisfunctionalWidgets() {
-  const QStringList &zTreeEntries = settings->installedZTreeVersions;
+  const QStringList &zTreeEntries = settings->GetInstalledZTreeVersions();
   if (zTreeEntries.isEmpty()) {
     ui->CBClientNames->setEnabled(false);
     // ui->GBzTree->setEnabled( false );
@@ -242,6 +242,7 @@ void lc::MainWindow::DisableDisfunctionalWidgets() {
   }
 
   if (settings->wineCmd.isEmpty()) {
+    ui->PBPrepareClients->setEnabled(false);
     ui->CBClientNames->setEnabled(false);
     ui->L_FakeName->setEnabled(false);
     ui->PBRunzLeaf->setEnabled(false);
@@ -260,6 +261,109 @@ void lc::MainWindow::DisableDisfunctionalWidgets() {
   }
 }
 
+void lc::MainWindow::FillClientNames() {
+  ui->CBClientNames->clear();
+  for (auto *const client : settings->GetClients()) {
+    if (!clientsGridModel->GetDroppedClients().contains(client)) {
+      ui->CBClientNames->addItem(client->name);
+    }
+  }
+}
+
+/*!
+ * \brief Fill the widgets depending on the installed z-Tree versions and the
+ * receipts' components once they were checked
+ */
+void lc::MainWindow::GotDeferredChecksFinished() {
+  const bool firstRun = !deferredChecksFinished;
+  deferredChecksFinished = true;
+  if (firstRun) {
+    startupProfiler->Mark("Running the deferred checks");
+    qDebug().noquote() << startupProfiler->CreateReport();
+  }
+
+  // Pinging needs the verified 'ping' command, new clients start now, too
+  for (auto *const client : settings->GetClients()) {
+    client->StartPinging();
+  }
+
+  // The checks re-run after reloads of the settings, keep the user's choices
+  const QString zTreeVersion{ui->CBzTreeVersion->currentText()};
+  while (ui->CBzTreeVersion->count() > 1) {
+    ui->CBzTreeVersion->removeItem(1);
+  }
+  ui->CBzTreeVersion->addItems(settings->GetInstalledZTreeVersions());
+  if (!firstRun && ui->CBzTreeVersion->findText(zTreeVersion) > 0) {
+    ui->CBzTreeVersion->setCurrentIndex(
+        ui->CBzTreeVersion->findText(zTreeVersion));
+  }
+
+  const QString receiptsHeader{ui->CBReceiptsHeader->currentText()};
+  ui->CBReceiptsHeader->clear();
+  if (!settings->AreReceiptsAvailable()) {
+    if (firstRun) {
+      ShowInformation(tr("Receipts printing will not work"),
+                      tr("Some component essential for receipts creation and"
+                         " printing is missing. No receipts will be created or"
+                         " printed."));
+    }
+  } else {
+    ui->CBReceiptsHeader->addItems(
+        settings->GetAvailableReceiptsTemplates());
+
+    if (!firstRun && ui->CBReceiptsHeader->findText(receiptsHeader) >= 0) {
+      ui->CBReceiptsHeader->setCurrentIndex(
+          ui->CBReceiptsHeader->findText(receiptsHeader));
+    } else if (settings->defaultReceiptIndex &&
+               settings->defaultReceiptIndex <
+                   ui->CBReceiptsHeader->count()) {
+      ui->CBReceiptsHeader->setCurrentIndex(settings->defaultReceiptIndex);
+    }
+    if (firstRun) {
+      ResumeReceiptsJobs();
+    }
+  }
+}
+
+/*!
+ * \brief Show the clients of the reloaded settings
+ *
+ * Only the cells of added, removed or moved clients are updated, so that the
+ * states of the remaining clients and running sessions are not disturbed.
+ *
+ * \param[in] argAddedClients The number of clients which were newly created
+ * \param[in] argRemovedClients The number of clients which were retired
+ */
+void lc::MainWindow::GotSettingsReloaded(const int argAddedClients,
+                                         const int argRemovedClients) {
+  connect(settings.get(), &Settings::DeferredChecksFinished, this,
+          &MainWindow::GotDeferredChecksFinished);
+
+  const QStringList previousRooms{clientsGridModel->GetRooms()};
+  clientsGridModel->SetClients(settings->GetClients());
+  if (clientsGridModel->GetRooms() != previousRooms) {
+    SetupRoomsTabBar();
+  }
+  FillClientNames();
+  // Open thumbnail walls drop removed clients, those of all clients add new
+  for (auto *const thumbnailWall : findChildren<ThumbnailWall *>()) {
+    QVector<Client *> clients;
+    for (auto *const client : settings->GetClients()) {
+      if (thumbnailWall->ShowsAllClients() ||
+          thumbnailWall->GetClients().contains(client)) {
+        clients.append(client);
+      }
+    }
+    thumbnailWall->SetClients(clients);
+  }
+
+  statusBar()->showMessage(tr("The settings were reloaded, %1 clients were"
+                              " added and %2 removed.")
+                               .arg(argAddedClients)
+                               .arg(argRemovedClients),
+                           10000);
+}
+
 void lc::MainWindow::LoadIconPixmaps() {
   if (settings->lcDataDir.isEmpty()) {
     return;
@@ -311,19 +415,13 @@ void lc::MainWindow::on_PBPrintPaymentFileManually_clicked() {
           SLOT(deleteLater()));
   connect(manPrint, &ManualPrintingSetup::RequestReceiptsHandler, this,
           &MainWindow::StartReceiptsHandler);
+  connect(manPrint, &ManualPrintingSetup::RequestReceiptsBatch, this,
+          &MainWindow::StartReceiptsBatch);
 }
 
 void lc::MainWindow::on_PBRunzLeaf_clicked() {
   // Check if more than one client is selected and issue a warning message if so
-  unsigned short int numberOfSelectedClients = 0;
-  QModelIndexList activatedItems =
-      ui->TVClients->selectionModel()->selectedIndexes();
-  for (QModelIndexList::ConstIterator it = activatedItems.cbegin();
-       it != activatedItems.cend(); ++it) {
-    if ((*it).data(Qt::DisplayRole).type() != 0) {
-      ++numberOfSelectedClients;
-    }
-  }
+  const int numberOfSelectedClients = clientSelection->GetSelectedCount();
   qDebug() << numberOfSelectedClients << "clients are selected.";
   if (numberOfSelectedClients > 1) {
     QMessageBox messageBox{
@@ -333,17 +431,8 @@ void lc::MainWindow::on_PBRunzLeaf_clicked() {
         QMessageBox::Ok, this};
     messageBox.exec();
   } else {
-    const QString *const fakeName =
-        new QString{ui->CBClientNames->currentText()};
-    for (QModelIndexList::ConstIterator it = activatedItems.cbegin();
-         it != activatedItems.cend(); ++it) {
-      if ((*it).data(Qt::DisplayRole).type() != 0) {
-        Client *client =
-            static_cast<Client *>((*it).data(Qt::UserRole).value<void *>());
-        client->StartZLeaf(fakeName);
-      }
-    }
-    delete fakeName;
+    StartZLeaves(clientSelection->GetSelectedClients(), QString{},
+                 ui->CBClientNames->currentText());
   }
 }
 
@@ -353,46 +442,122 @@ void lc::MainWindow::on_RBUseLocalUser_toggled(bool checked) {
   }
 }
 
+/*!
+ * \brief Start everything which is not needed for the first frame
+ *
+ * This runs in the first iteration of the event loop, after the main window
+ * was shown.
+ */
+void lc::MainWindow::StartDeferredInitialization() {
+  startupProfiler->Mark("Processing the first events");
+  settings->RunDeferredChecks();
+}
+
+void lc::MainWindow::SetupDiagnosticsTab() {
+  const InstrumentedApplication *const application =
+      qobject_cast<InstrumentedApplication *>(qApp);
+  if (!application || !application->GetInstrumentation()) {
+    return;
+  }
+
+  QPlainTextEdit *const diagnosticsView = new QPlainTextEdit{this};
+  diagnosticsView->setLineWrapMode(QPlainTextEdit::NoWrap);
+  diagnosticsView->setReadOnly(true);
+  ui->TWExperimenterTab->addTab(diagnosticsView, tr("Diagnostics"));
+
+  // The report is only refreshed while it is visible
+  QTimer *const diagnosticsTimer = new QTimer{this};
+  diagnosticsTimer->setObjectName("diagnosticsTimer");
+  connect(diagnosticsTimer, &QTimer::timeout, this,
+          [application, diagnosticsView]() {
+            if (diagnosticsView->isVisible()) {
+              diagnosticsView->setPlainText(
+                  startupProfiler->CreateReport() + "\n" +
+                  application->GetInstrumentation()->CreateReport());
+            }
+          });
+  diagnosticsTimer->start(2000);
+}
+
+void lc::MainWindow::SetupRoomsTabBar() {
+  delete roomsTabBar;
+  roomsTabBar = nullptr;
+  if (clientsGridModel->GetRooms().size() < 2) {
+    return;
+  }
+
+  roomsTabBar = new QTabBar{this};
+  for (const auto &room : clientsGridModel->GetRooms()) {
+    roomsTabBar->addTab(room.isEmpty() ? tr("Unassigned") : room);
+  }
+  ui->verticalLayout_8->insertWidget(
+      ui->verticalLayout_8->indexOf(ui->LMVClients), roomsTabBar);
+  connect(roomsTabBar, &QTabBar::currentChanged, ui->LMVClients,
+          &LabMapView::SetRoom);
+  connect(ui->LMVClients, &LabMapView::RoomShown, roomsTabBar,
+          &QTabBar::setCurrentIndex);
+}
+
 void lc::MainWindow::SetupWidgets() {
-  // Fill the 'CBClientNames' with possible client names and the 'TVClients'
+  // Fill the 'CBClientNames' with possible client names and the 'LMVClients'
   // with the clients
+  clientsGridModel = new ClientsGridModel{settings->GetClients(), icons, this};
+  QItemSelectionModel *const clientsSelectionModel =
+      new QItemSelectionModel{clientsGridModel, this};
+  ui->LMVClients->SetModel(clientsGridModel, clientsSelectionModel);
+  clientSelection =
+      new ClientSelection{clientsGridModel, clientsSelectionModel, this};
+
+  SetupRoomsTabBar();
+
+  // Display the progress of session starts without blocking
+  sessionStartProgress = new QProgressBar{this};
+  sessionStartProgress->setMaximumWidth(200);
+  sessionStartProgress->hide();
+  statusBar()->addPermanentWidget(sessionStartProgress);
+
+  // Queue help requests in a panel instead of interrupting with dialogs
+  if (lablib->GetClientHelpNotificationServer()) {
+    HelpRequestsPanel *const helpRequestsPanel = new HelpRequestsPanel{this};
+    QDockWidget *const helpRequestsDock =
+        new QDockWidget{tr("Help requests"), this};
+    helpRequestsDock->setObjectName("DWHelpRequests");
+    helpRequestsDock->setWidget(helpRequestsPanel);
+    addDockWidget(Qt::RightDockWidgetArea, helpRequestsDock);
+    connect(lablib->GetClientHelpNotificationServer(),
+            &ClientHelpNotificationServer::HelpRequested, helpRequestsPanel,
+            &HelpRequestsPanel::AddHelpRequest);
+    connect(lablib->GetClientHelpNotificationServer(),
+            &ClientHelpNotificationServer::HelpRequested, this,
+            [this, helpRequestsDock](const QString &argPeerAddress,
+                                     Client *argClient) {
+              helpRequestsDock->show();
+              helpRequestsDock->raise();
+              statusBar()->showMessage(
+                  tr("%1 asked for help.")
+                      .arg(argClient ? argClient->name : argPeerAddress),
+                  10000);
+              QApplication::alert(this);
+            });
+    connect(helpRequestsPanel, &HelpRequestsPanel::HelpRequestStateChanged,
+            ui->LMVClients, &LabMapView::SetHelpRequested);
+    connect(helpRequestsPanel, &HelpRequestsPanel::ShowClientRequested,
+            ui->LMVClients, &LabMapView::ShowClient);
+  }
   if (!settings->GetClients().isEmpty()) {
-    valid_items = new QVector<QStandardItem *>;
-    valid_items->reserve(settings->GetClients().size());
-    clients_view_model = new QStandardItemModel{this};
-    for (auto *s : settings->GetClients()) {
-      int temp_xpos = s->xPosition - 1, temp_ypos = s->yPosition - 1;
-
-      // Check if a client already exists at the given position and skip, if so
-      if (clients_view_model->item(temp_ypos, temp_xpos)) {
-        QMessageBox::information(this, tr("Double assignment to one position"),
-                                 tr("Two clients where set for the same "
-                                    "position, '%1' will be dropped.")
-                                     .arg(s->name));
-        continue;
-      }
-
-      // Work to be done for the 'CBClientNames'
-      ui->CBClientNames->addItem(s->name);
-
-      // Work to be done for the 'TVClients'
-      QStandardItem *item = new QStandardItem(s->name);
-      item->setBackground(QBrush(QColor(127, 255, 127, 255)));
-      QVariant v = qVariantFromValue(static_cast<void *>(s));
-      item->setData(v, Qt::UserRole);
-      item->setIcon(icons[(int)icons_t::UNKNOWN]);
-      clients_view_model->setItem(temp_ypos, temp_xpos, item);
-      valid_items->append(item);
+    // Clients at an already occupied position were not placed in the grid
+    for (auto *s : clientsGridModel->GetDroppedClients()) {
+      QMessageBox::information(this, tr("Double assignment to one position"),
+                               tr("Two clients where set for the same "
+                                  "position, '%1' will be dropped.")
+                                   .arg(s->name));
     }
-    ui->TVClients->setModel(clients_view_model);
-    valid_items->squeeze();
+    FillClientNames();
   } else {
-    QMessageBox messageBox{
-        QMessageBox::Warning, tr("Could not construct clients view"),
+    ShowInformation(
+        tr("Could not construct clients view"),
         tr("The creation of the clients view failed. Please check the file "
-           "'/etc/xdg/Labcontrol/Labcontrol.conf'."),
-        QMessageBox::Ok, this};
-    messageBox.exec();
+           "'/etc/xdg/Labcontrol/Labcontrol.conf'."));
     ui->CBClientNames->setEnabled(false);
     ui->GBClientActions->setEnabled(false);
     ui->LEFilePath->setEnabled(false);
@@ -401,7 +566,7 @@ void lc::MainWindow::SetupWidgets() {
     ui->PBChooseFile->setEnabled(false);
     ui->PBRunzLeaf->setEnabled(false);
     ui->TAdminActions->setEnabled(false);
-    ui->TVClients->setEnabled(false);
+    ui->LMVClients->setEnabled(false);
   }
 
   // Fill the 'CBWebcamChooser' with all available network webcams
@@ -490,53 +655,54 @@ void lc::MainWindow::StartReceiptsHandler(
           &ReceiptsHandler::deleteLater);
 }
 
-void lc::MainWindow::UpdateClientsTableView() {
-  for (auto s : *valid_items) {
-    Client::State state =
-        static_cast<Client *>(s->data(Qt::UserRole).value<void *>())
-            ->GetClientState();
-    switch (state) {
-    case Client::State::RESPONDING:
-      s->setBackground(QBrush(QColor(128, 255, 128, 255)));
-      s->setIcon(icons[(int)icons_t::ON]);
-      break;
-    case Client::State::NOT_RESPONDING:
-      s->setBackground(QBrush(QColor(255, 255, 128, 255)));
-      s->setIcon(icons[(int)icons_t::OFF]);
-      break;
-    case Client::State::BOOTING:
-      s->setBackground(QBrush(QColor(128, 128, 255, 255)));
-      s->setIcon(icons[(int)icons_t::BOOT]);
-      break;
-    case Client::State::SHUTTING_DOWN:
-      s->setBackground(QBrush(QColor(128, 128, 255, 255)));
-      s->setIcon(icons[(int)icons_t::DOWN]);
-      break;
-    case Client::State::ZLEAF_RUNNING:
-      s->setBackground(QBrush(QColor(0, 255, 0, 255)));
-      s->setIcon(icons[(int)icons_t::ZLEAF]);
-      break;
-    case Client::State::UNINITIALIZED:
-    case Client::State::ERROR:
-      s->setBackground(QBrush(QColor(255, 128, 128, 255)));
-      break;
+/*!
+ * \brief Resume the receipts jobs interrupted by a crash or by quitting
+ */
+void lc::MainWindow::ResumeReceiptsJobs() {
+  for (const auto &job : receiptsJournal->TakeJobsToResume()) {
+    // Jobs of unavailable templates stay in the journal for a later start
+    if (!settings->IsReceiptsTemplateAvailable(job.templateName)) {
+      qDebug() << "Not resuming the receipts job of" << job.paymentFilePath
+               << "since its template" << job.templateName
+               << "is not available";
+      continue;
     }
+    const QFileInfo paymentFileInfo{job.paymentFilePath};
+    qDebug() << "Resuming the receipts job of" << job.paymentFilePath;
+    StartReceiptsHandler(paymentFileInfo.path(), job.receiptsForLocalClients,
+                         job.anonymousReceiptsPlaceholder, job.templateName,
+                         paymentFileInfo.completeBaseName());
   }
 }
 
+void lc::MainWindow::StartReceiptsBatch(
+    const QString &argDirectory, bool argReceiptsForLocalClients,
+    const QString &argAnonymousReceiptsPlaceholder,
+    const QString &argTemplateName, ReceiptsBatch::Grouping argGrouping) {
+  ReceiptsBatch *const batch{new ReceiptsBatch{
+      argDirectory, argReceiptsForLocalClients,
+      argAnonymousReceiptsPlaceholder, argTemplateName, argGrouping, this}};
+  connect(batch, &ReceiptsBatch::Finished, this,
+          [this, argDirectory, batch](const QStringList &argCreatedFiles,
+                                      const QStringList &argFailedFiles) {
+            batch->deleteLater();
+            QString text{tr("%n PDF file(s) were created in '%1'.", "",
+                            argCreatedFiles.size())
+                             .arg(argDirectory)};
+            if (!argFailedFiles.isEmpty()) {
+              text += "\n\n" + tr("The following PDF files could not be "
+                                   "created:\n%1")
+                                    .arg(argFailedFiles.join("\n"));
+            }
+            ShowInformation(tr("Batch reprint finished"), text);
+          });
+  batch->Start();
+}
+
 /* Experiment tab functions */
 
 void lc::MainWindow::on_PBBoot_clicked() {
-  QModelIndexList activatedItems =
-      ui->TVClients->selectionModel()->selectedIndexes();
-  for (QModelIndexList::ConstIterator it = activatedItems.cbegin();
-       it != activatedItems.cend(); ++it) {
-    if ((*it).data(Qt::DisplayRole).type() != 0) {
-      Client *client =
-          static_cast<Client *>((*it).data(Qt::UserRole).value<void *>());
-      client->Boot();
-    }
-  }
+  lablib->GetBootScheduler()->Boot(clientSelection->GetSelectedClients());
 }
 
 void lc::MainWindow::on_PBChooseFile_clicked() {
@@ -558,22 +724,15 @@ void lc::MainWindow::on_PBChooseFile_clicked() {
 }
 
 void lc::MainWindow::on_PBBeamFile_clicked() {
-  QModelIndexList activatedItems =
-      ui->TVClients->selectionModel()->selectedIndexes();
   const QString fileToBeam{ui->LEFilePath->text()};
   if (fileToBeam == "") {
     QMessageBox::information(this, "Upload failed",
                              "You didn't choose any folder to upload.");
   } else {
     // Iterate over the selected clients to upload the file
-    for (QModelIndexList::ConstIterator it = activatedItems.cbegin();
-         it != activatedItems.cend(); ++it) {
-      if ((*it).data(Qt::DisplayRole).type() != 0) {
-        Client *client =
-            static_cast<Client *>((*it).data(Qt::UserRole).value<void *>());
-        client->BeamFile(fileToBeam, &settings->pkeyPathUser,
-                         &settings->userNameOnClients);
-      }
+    for (auto *const client : clientSelection->GetSelectedClients()) {
+      client->BeamFile(fileToBeam, &settings->pkeyPathUser,
+                       &settings->userNameOnClients);
     }
     // Inform the user about the path
     QMessageBox::information(
@@ -589,6 +748,32 @@ void lc::MainWindow::on_PBShowORSEE_clicked() { lablib->ShowOrsee(); }
 
 void lc::MainWindow::on_PBShowPreprints_clicked() { lablib->ShowPreprints(); }
 
+void lc::MainWindow::on_PBShowThumbnailWall_clicked() {
+  QVector<Client *> clients = clientSelection->GetSelectedClients();
+  const bool showsAllClients = clients.isEmpty();
+  if (showsAllClients) {
+    clients = settings->GetClients();
+  }
+  ThumbnailWall *const thumbnailWall =
+      new ThumbnailWall{clients, showsAllClients, this};
+  thumbnailWall->setAttribute(Qt::WA_DeleteOnClose);
+  thumbnailWall->setWindowFlags(Qt::Window);
+  thumbnailWall->resize(1400, 900);
+  thumbnailWall->show();
+}
+
+void lc::MainWindow::on_PBShowzLeafStartTimes_clicked() {
+  QPlainTextEdit *const reportView = new QPlainTextEdit{this};
+  reportView->setAttribute(Qt::WA_DeleteOnClose);
+  reportView->setWindowFlags(Qt::Window);
+  reportView->setWindowTitle(tr("z-Leaf start times"));
+  reportView->setLineWrapMode(QPlainTextEdit::NoWrap);
+  reportView->setReadOnly(true);
+  reportView->setPlainText(lablib->GetZLeafStartTracer()->CreateReport());
+  reportView->resize(800, 600);
+  reportView->show();
+}
+
 void lc::MainWindow::on_PBShutdown_clicked() {
   // Confirmation dialog
   QMessageBox::StandardButton reply;
@@ -596,21 +781,14 @@ void lc::MainWindow::on_PBShutdown_clicked() {
                                 "Really shutdown the selected clients?",
                                 QMessageBox::Yes | QMessageBox::No);
   if (reply == QMessageBox::Yes) {
-    QModelIndexList activatedItems =
-        ui->TVClients->selectionModel()->selectedIndexes();
-    for (QModelIndexList::ConstIterator it = activatedItems.cbegin();
-         it != activatedItems.cend(); ++it) {
-      if ((*it).data(Qt::DisplayRole).type() != 0) {
-        Client *client =
-            static_cast<Client *>((*it).data(Qt::UserRole).value<void *>());
-        // Do not shut down the server itself
-        if (client->name == "self") {
-          QMessageBox::information(NULL, "Shutdown canceled",
-                                   "It is not allowed to shutdown the server "
-                                   "itself via labcontrol!");
-        } else {
-          client->Shutdown();
-        }
+    for (auto *const client : clientSelection->GetSelectedClients()) {
+      // Do not shut down the server itself
+      if (client->name == "self") {
+        QMessageBox::information(NULL, "Shutdown canceled",
+                                 "It is not allowed to shutdown the server "
+                                 "itself via labcontrol!");
+      } else {
+        client->Shutdown();
       }
     }
   } else {
@@ -637,15 +815,8 @@ void lc::MainWindow::on_CBWebcamChooser_activated(int argIndex) {
 void lc::MainWindow::on_PBstartBrowser_clicked() {
   QString argURL = ui->LEURL->text();
   bool argFullscreen = ui->CBFullscreen->checkState();
-  QModelIndexList activated_items =
-      ui->TVClients->selectionModel()->selectedIndexes();
-  for (QModelIndexList::ConstIterator it = activated_items.cbegin();
-       it != activated_items.cend(); ++it) {
-    if ((*it).data(Qt::DisplayRole).type() != 0) {
-      Client *client =
-          static_cast<Client *>((*it).data(Qt::UserRole).value<void *>());
-      client->StartClientBrowser(&argURL, &argFullscreen);
-    }
+  for (auto *const client : clientSelection->GetSelectedClients()) {
+    client->StartClientBrowser(&argURL, &argFullscreen);
   }
 }
 
@@ -656,15 +827,8 @@ void lc::MainWindow::on_PBstopBrowser_clicked() {
                                 "Really kill all selected browser instances?",
                                 QMessageBox::Yes | QMessageBox::No);
   if (reply == QMessageBox::Yes) {
-    QModelIndexList activated_items =
-        ui->TVClients->selectionModel()->selectedIndexes();
-    for (QModelIndexList::ConstIterator it = activated_items.cbegin();
-         it != activated_items.cend(); ++it) {
-      if ((*it).data(Qt::DisplayRole).type() != 0) {
-        Client *client =
-            static_cast<Client *>((*it).data(Qt::UserRole).value<void *>());
-        client->StopClientBrowser();
-      }
+    for (auto *const client : clientSelection->GetSelectedClients()) {
+      client->StopClientBrowser();
     }
   } else {
     qDebug() << "Canceled stopping all selected browser processes";
@@ -673,43 +837,27 @@ void lc::MainWindow::on_PBstopBrowser_clicked() {
 
 // View only VNC button
 void lc::MainWindow::on_PBViewDesktopViewOnly_clicked() {
-  QModelIndexList activatedItems =
-      ui->TVClients->selectionModel()->selectedIndexes();
-  for (QModelIndexList::ConstIterator it = activatedItems.cbegin();
-       it != activatedItems.cend(); ++it) {
-    if ((*it).data(Qt::DisplayRole).type() != 0) {
-      Client *client =
-          static_cast<Client *>((*it).data(Qt::UserRole).value<void *>());
-      client->ShowDesktopViewOnly();
-    }
+  for (auto *const client : clientSelection->GetSelectedClients()) {
+    client->ShowDesktopViewOnly();
   }
 }
 
 // Full control VNC button
 void lc::MainWindow::on_PBViewDesktopFullControl_clicked() {
-  QModelIndexList activatedItems =
-      ui->TVClients->selectionModel()->selectedIndexes();
-  for (QModelIndexList::ConstIterator it = activatedItems.cbegin();
-       it != activatedItems.cend(); ++it) {
-    if ((*it).data(Qt::DisplayRole).type() != 0) {
-      Client *client =
-          static_cast<Client *>((*it).data(Qt::UserRole).value<void *>());
-      client->ShowDesktopFullControl();
-    }
+  for (auto *const client : clientSelection->GetSelectedClients()) {
+    client->ShowDesktopFullControl();
   }
 }
 
 /* Session tab functions */
 void lc::MainWindow::on_PBStartzLeaf_clicked() {
-  QModelIndexList activated_items =
-      ui->TVClients->selectionModel()->selectedIndexes();
-  for (QModelIndexList::ConstIterator it = activated_items.cbegin();
-       it != activated_items.cend(); ++it) {
-    if ((*it).data(Qt::DisplayRole).type() != 0) {
-      Client *client =
-          static_cast<Client *>((*it).data(Qt::UserRole).value<void *>());
-      client->StartZLeaf(nullptr, ui->LEzLeafCommandline->text());
-    }
+  StartZLeaves(clientSelection->GetSelectedClients(),
+               ui->LEzLeafCommandline->text());
+}
+
+void lc::MainWindow::on_PBPrepareClients_clicked() {
+  for (auto *const client : clientSelection->GetSelectedClients()) {
+    client->PrepareWine();
   }
 }
 
@@ -726,8 +874,9 @@ void lc::MainWindow::on_PBStartLocalzLeaf_clicked() {
 void lc::MainWindow::StartLocalzLeaf(const QString &argzLeafName,
                                      const QString &argzLeafVersion,
                                      const quint16 argzTreePort) {
-  if (settings->tasksetCmd.isEmpty() || settings->wineCmd.isEmpty() ||
-      settings->zTreeInstDir.isEmpty()) {
+  if (!settings->IsPathAvailable(settings->tasksetCmd) ||
+      !settings->IsPathAvailable(settings->wineCmd) ||
+      !settings->IsPathAvailable(settings->zTreeInstDir)) {
     return;
   }
 
@@ -778,7 +927,7 @@ void lc::MainWindow::on_PBRecoverCrashedSession_clicked() {
   // zenity script)
   QProcess startProc;
   startProc.setProcessEnvironment(QProcessEnvironment::systemEnvironment());
-  if (!settings->restartCrashedSessionScript.isEmpty()) {
+  if (settings->IsPathAvailable(settings->restartCrashedSessionScript)) {
     startProc.startDetached(settings->restartCrashedSessionScript);
   }
 }
@@ -821,88 +970,186 @@ void lc::MainWindow::on_ChBPrintanonymousreceipts_clicked() {
 void lc::MainWindow::on_PBStartSession_clicked() {
 
   if (ui->CBzTreeVersion->currentIndex() == 0) {
-    QMessageBox::information(
-        this, tr("No z-Tree version chosen"),
-        tr("A z-Tree version was not chosen, yet. This setting is"
-           " mandatory."),
-        QMessageBox::Ok);
+    ShowInformation(tr("No z-Tree version chosen"),
+                    tr("A z-Tree version was not chosen, yet. This setting is"
+                       " mandatory."));
     return;
   }
 
-  const QModelIndexList activatedItems =
-      ui->TVClients->selectionModel()->selectedIndexes();
+  SessionStarter::Parameters parameters;
+  parameters.clients = clientSelection->GetSelectedClients();
   if (!ui->ChBSessionWithoutAttachedClients->isChecked()) {
-    if (!activatedItems.length()) {
-      QMessageBox::information(
-          this, tr("Canceled, no clients were chosen"),
-          tr("The start of a new session was canceled.\n"
-             " Some clients have to be selected first or the"
-             " creation of sessions without clients must be"
-             " allowed with the checkbox."));
+    if (parameters.clients.isEmpty()) {
+      ShowInformation(tr("Canceled, no clients were chosen"),
+                      tr("The start of a new session was canceled.\n"
+                         " Some clients have to be selected first or the"
+                         " creation of sessions without clients must be"
+                         " allowed with the checkbox."));
       return;
     }
   }
 
-  QString anonymousReceiptsPlaceholder;
   if (ui->ChBPrintAnonymousReceipts->isChecked()) {
-    anonymousReceiptsPlaceholder = ui->CBReplaceParticipantNames->currentText();
-  }
-
-  QVector<Client *> associatedClients;
-  for (auto cit = activatedItems.cbegin(); cit != activatedItems.cend();
-       ++cit) {
-    if ((*cit).data(Qt::DisplayRole).type() != 0) {
-      Client *client =
-          static_cast<Client *>((*cit).data(Qt::UserRole).value<void *>());
-      client->SetSessionPort(ui->SBPort->value());
-      client->SetzLeafVersion(ui->CBzTreeVersion->currentText());
-      associatedClients.append(client);
+    parameters.participNameReplacement =
+        ui->CBReplaceParticipantNames->currentText();
+  }
+  parameters.printLocalReceipts = ui->ChBReceiptsForLocalClients->isChecked();
+  parameters.receiptsHeader = ui->CBReceiptsHeader->currentText();
+  parameters.dataTargetPath = ui->CBDataTargetPath->currentText();
+  parameters.port = static_cast<quint16>(ui->SBPort->value());
+  parameters.zTreeVersion = ui->CBzTreeVersion->currentText();
+  parameters.startZLeaves = ui->ChBautoStartClientZleaf->isChecked();
+  parameters.zLeafCommand =
+      lablib->getzLeafArgs(parameters.port, parameters.zTreeVersion).join(" ");
+
+  // Only one session start may be in progress at a time
+  ui->PBStartSession->setEnabled(false);
+  auto *const starter = new SessionStarter{lablib, parameters, this};
+  connect(starter, &SessionStarter::Validated, this,
+          [this, starter]() { GotSessionStartValidated(starter); });
+  connect(starter, &SessionStarter::ProgressChanged, this,
+          [this](const int argDone, const int argTotal,
+                 const QString &argStage) {
+            sessionStartProgress->setRange(0, argTotal);
+            sessionStartProgress->setValue(argDone);
+            sessionStartProgress->show();
+            statusBar()->showMessage(argStage);
+          });
+  connect(starter, &SessionStarter::Finished, this,
+          [this, starter, parameters](const bool argSuccess,
+                                      const QString &argMessage) {
+            sessionStartProgress->hide();
+            ui->PBStartSession->setEnabled(true);
+            starter->deleteLater();
+            if (!argSuccess) {
+              statusBar()->clearMessage();
+              ShowInformation(tr("The session could not be started"),
+                              argMessage);
+              return;
+            }
+            statusBar()->showMessage(argMessage, 10000);
+
+            // Display the command line
+            ui->LEzLeafCommandline->setText(parameters.zLeafCommand);
+            // Set chosen Port
+            settings->SetChosenZTreePort(parameters.port);
+            // Increment port number
+            ui->SBPort->setValue(parameters.port + 1);
+          });
+  statusBar()->showMessage(tr("Validating the session start"));
+  starter->Validate();
+}
+
+/*!
+ * \brief Ask once about all conflicts of a session start and run it
+ *
+ * \param[in] argStarter The validated starter of the session
+ */
+void lc::MainWindow::GotSessionStartValidated(
+    SessionStarter *const argStarter) {
+  const SessionStarter::Conflicts &conflicts = argStarter->GetConflicts();
+  // An occupied port cannot be overridden, so the start reports it as failure
+  if (conflicts.IsEmpty() || conflicts.portOccupied) {
+    argStarter->Start(false);
+    return;
+  }
+
+  auto *const messageBox = new QMessageBox{
+      QMessageBox::Question, tr("Start the session nonetheless?"),
+      conflicts.Describe(), QMessageBox::Cancel, this};
+  messageBox->setAttribute(Qt::WA_DeleteOnClose);
+  QPushButton *const restartButton =
+      conflicts.runningZLeaves.isEmpty()
+          ? nullptr
+          : messageBox->addButton(tr("Start and restart running z-Leaves"),
+                                  QMessageBox::AcceptRole);
+  QPushButton *const startButton =
+      messageBox->addButton(tr("Start"), QMessageBox::AcceptRole);
+  messageBox->setDefaultButton(startButton);
+  connect(messageBox, &QMessageBox::finished, argStarter,
+          [this, argStarter, messageBox, restartButton, startButton]() {
+            QAbstractButton *const clicked = messageBox->clickedButton();
+            if (clicked != nullptr && clicked == restartButton) {
+              argStarter->Start(true);
+            } else if (clicked == startButton) {
+              argStarter->Start(false);
+            } else {
+              argStarter->deleteLater();
+              ui->PBStartSession->setEnabled(true);
+              statusBar()->showMessage(tr("The session start was canceled"),
+                                       10000);
+            }
+          });
+  messageBox->open();
+}
+
+/*!
+ * \brief Show an information to the user without blocking the event loop
+ *
+ * \param[in] argTitle The title of the message box
+ * \param[in] argText The information to be shown
+ */
+void lc::MainWindow::ShowInformation(const QString &argTitle,
+                                     const QString &argText) {
+  auto *const messageBox = new QMessageBox{QMessageBox::Information, argTitle,
+                                           argText, QMessageBox::Ok, this};
+  messageBox->setAttribute(Qt::WA_DeleteOnClose);
+  messageBox->open();
+}
+
+/*!
+ * \brief Start z-Leaves on the given clients, asking once about running ones
+ *
+ * \param[in] argClients The clients on which z-Leaves shall be started
+ * \param[in] argCommand The command line starting the z-Leaf
+ * \param[in] argFakeName The name the z-Leaves shall have (empty for the
+ * clients' host names)
+ */
+void lc::MainWindow::StartZLeaves(const QVector<Client *> &argClients,
+                                  const QString &argCommand,
+                                  const QString &argFakeName) {
+  QVector<Client *> runningZLeaves;
+  for (auto *const client : argClients) {
+    if (client->GetClientState() == Client::State::ZLEAF_RUNNING) {
+      runningZLeaves.append(client);
     }
   }
 
-  this->lablib->StartNewSession(associatedClients, anonymousReceiptsPlaceholder,
-                                ui->ChBReceiptsForLocalClients->isChecked(),
-                                ui->CBReceiptsHeader->currentText(),
-                                ui->CBDataTargetPath->currentText(),
-                                static_cast<quint16>(ui->SBPort->value()),
-                                ui->CBzTreeVersion->currentText());
-
-  // Display the command line
-  QString cmd =
-      this->lablib
-          ->getzLeafArgs(ui->SBPort->value(), ui->CBzTreeVersion->currentText())
-          .join(" ");
-  ui->LEzLeafCommandline->setText(cmd);
-
-  // Start z-Leaf on selected clients if checkbox is activated
-  if (ui->ChBautoStartClientZleaf->isChecked()) {
-    for (auto cit = activatedItems.cbegin(); cit != activatedItems.cend();
-         ++cit) {
-      if ((*cit).data(Qt::DisplayRole).type() != 0) {
-        Client *client =
-            static_cast<Client *>((*cit).data(Qt::UserRole).value<void *>());
-        client->StartZLeaf(nullptr, cmd);
-      }
+  auto start = [argClients, argCommand, argFakeName](const bool argRestart) {
+    for (auto *const client : argClients) {
+      client->StartZLeaf(argFakeName.isEmpty() ? nullptr : &argFakeName,
+                         argCommand, argRestart);
     }
+  };
+  if (runningZLeaves.isEmpty()) {
+    start(false);
+    return;
   }
 
-  // Set chosen Port
-  settings->SetChosenZTreePort(ui->SBPort->text().toInt());
-  // Increment port number
-  int newPort = ui->SBPort->text().toInt() + 1;
-  ui->SBPort->setValue(newPort);
+  QStringList names;
+  for (const auto *const client : runningZLeaves) {
+    names.append(client->name);
+  }
+  auto *const messageBox = new QMessageBox{
+      QMessageBox::Warning, tr("Running z-Leaves found"),
+      tr("There is already a z-Leaf running on %n client(s): %1", nullptr,
+         runningZLeaves.size())
+          .arg(names.join(", ")),
+      QMessageBox::No | QMessageBox::Yes, this};
+  messageBox->setInformativeText(
+      tr("Do you want to start z-Leaves on these clients nonetheless?"));
+  messageBox->setDefaultButton(QMessageBox::No);
+  messageBox->setAttribute(Qt::WA_DeleteOnClose);
+  connect(messageBox, &QMessageBox::finished, this,
+          [start](const int argResult) {
+            start(argResult == QMessageBox::Yes);
+          });
+  messageBox->open();
 }
 
 void lc::MainWindow::on_PBKillzLeaf_clicked() {
-  QModelIndexList activated_items =
-      ui->TVClients->selectionModel()->selectedIndexes();
-  for (QModelIndexList::ConstIterator it = activated_items.cbegin();
-       it != activated_items.cend(); ++it) {
-    if ((*it).data(Qt::DisplayRole).type() != 0) {
-      Client *client =
-          static_cast<Client *>((*it).data(Qt::UserRole).value<void *>());
-      client->KillZLeaf();
-    }
+  for (auto *const client : clientSelection->GetSelectedClients()) {
+    client->KillZLeaf();
   }
 }
 
@@ -917,15 +1164,8 @@ void lc::MainWindow::on_PBOpenFilesystem_clicked() {
     userToBeUsed = new QString{settings->userNameOnClients};
   }
 
-  QModelIndexList activated_items =
-      ui->TVClients->selectionModel()->selectedIndexes();
-  for (QModelIndexList::ConstIterator it = activated_items.cbegin();
-       it != activated_items.cend(); ++it) {
-    if ((*it).data(Qt::DisplayRole).type() != 0) {
-      Client *client =
-          static_cast<Client *>((*it).data(Qt::UserRole).value<void *>());
-      client->OpenFilesystem(userToBeUsed);
-    }
+  for (auto *const client : clientSelection->GetSelectedClients()) {
+    client->OpenFilesystem(userToBeUsed);
   }
   delete userToBeUsed;
 }
@@ -944,15 +1184,20 @@ void lc::MainWindow::on_PBExecute_clicked() {
   }
 
   qDebug() << "Executing command" << command << " on chosen clients.";
-  QModelIndexList activated_items =
-      ui->TVClients->selectionModel()->selectedIndexes();
-  for (QModelIndexList::ConstIterator it = activated_items.cbegin();
-       it != activated_items.cend(); ++it) {
-    if ((*it).data(Qt::DisplayRole).type() != 0) {
-      Client *client =
-          static_cast<Client *>((*it).data(Qt::UserRole).value<void *>());
+  const QVector<Client *> chosenClients = clientSelection->GetSelectedClients();
+  if (!ui->ChBExecuteHeadless->isChecked()) {
+    for (auto *const client : chosenClients) {
       client->OpenTerminal(command, ui->RBUseUserRoot->isChecked());
     }
+  } else if (!chosenClients.isEmpty()) {
+    // Collect the output of all clients in one window
+    CommandExecution *const execution = new CommandExecution{
+        chosenClients, command, ui->RBUseUserRoot->isChecked()};
+    CommandOutputWindow *const outputWindow =
+        new CommandOutputWindow{execution, this};
+    outputWindow->setWindowFlags(Qt::Window);
+    outputWindow->show();
+    execution->Start();
   }
 }
 
@@ -964,15 +1209,8 @@ void lc::MainWindow::on_PBOpenTerminal_clicked() {
   } else {
     pkeyPathUser = settings->pkeyPathUser;
   }
-  QModelIndexList activated_items =
-      ui->TVClients->selectionModel()->selectedIndexes();
-  for (QModelIndexList::ConstIterator it = activated_items.cbegin();
-       it != activated_items.cend(); ++it) {
-    if ((*it).data(Qt::DisplayRole).type() != 0) {
-      Client *client =
-          static_cast<Client *>((*it).data(Qt::UserRole).value<void *>());
-      client->OpenTerminal(QString{}, ui->RBUseUserRoot->isChecked());
-    }
+  for (auto *const client : clientSelection->GetSelectedClients()) {
+    client->OpenTerminal(QString{}, ui->RBUseUserRoot->isChecked());
   }
 }
 
@@ -986,15 +1224,8 @@ void lc::MainWindow::on_PBEnableRMB_clicked() {
       QMessageBox::Yes | QMessageBox::No);
   if (reply == QMessageBox::Yes) {
     qDebug() << "Enabling RMB on chosen clients.";
-    QModelIndexList activated_items =
-        ui->TVClients->selectionModel()->selectedIndexes();
-    for (QModelIndexList::ConstIterator it = activated_items.cbegin();
-         it != activated_items.cend(); ++it) {
-      if ((*it).data(Qt::DisplayRole).type() != 0) {
-        Client *client =
-            static_cast<Client *>((*it).data(Qt::UserRole).value<void *>());
-        client->ControlRMB(true);
-      }
+    for (auto *const client : clientSelection->GetSelectedClients()) {
+      client->ControlRMB(true);
     }
   }
 }
@@ -1009,15 +1240,8 @@ void lc::MainWindow::on_PBDisableRMB_clicked() {
       QMessageBox::Yes | QMessageBox::No);
   if (reply == QMessageBox::Yes) {
     qDebug() << "Disabling RMB on chosen clients.";
-    QModelIndexList activated_items =
-        ui->TVClients->selectionModel()->selectedIndexes();
-    for (QModelIndexList::ConstIterator it = activated_items.cbegin();
-         it != activated_items.cend(); ++it) {
-      if ((*it).data(Qt::DisplayRole).type() != 0) {
-        Client *client =
-            static_cast<Client *>((*it).data(Qt::UserRole).value<void *>());
-        client->ControlRMB(false);
-      }
+    for (auto *const client : clientSelection->GetSelectedClients()) {
+      client->ControlRMB(false);
     }
   }
 }
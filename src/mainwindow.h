@@ -20,18 +20,12 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
-enum class icons_t : unsigned short int {
-  UNKNOWN,
-  OFF,
-  DOWN,
-  BOOT,
-  ON,
-  ZLEAF,
-  ICON_QUANTITY
-};
-
 #include "Lib/client.h"
+#include "Lib/clientselection.h"
+#include "Lib/clientsgridmodel.h"
 #include "Lib/lablib.h"
+#include "Lib/receiptsbatch.h"
+#include "Lib/sessionstarter.h"
 #include "ui_mainwindow.h"
 
 #include <cmath>
@@ -39,8 +33,8 @@ enum class icons_t : unsigned short int {
 #include <QDir>
 #include <QFileDialog>
 #include <QMainWindow>
+#include <QProgressBar>
 #include <QSettings>
-#include <QStandardItemModel>
 #include <QThread>
 #include <QTimer>
 #include <QVector>
@@ -72,10 +66,13 @@ private slots:
   void on_PBKillLocalzLeaf_clicked();
   void on_PBOpenFilesystem_clicked();
   void on_PBOpenTerminal_clicked();
+  void on_PBPrepareClients_clicked();
   void on_PBPrintPaymentFileManually_clicked();
   void on_PBRunzLeaf_clicked();
   void on_PBShowORSEE_clicked();
   void on_PBShowPreprints_clicked();
+  void on_PBShowThumbnailWall_clicked();
+  void on_PBShowzLeafStartTimes_clicked();
   void on_PBShutdown_clicked();
   void on_PBStartLocalzLeaf_clicked();
   void on_PBStartSession_clicked();
@@ -83,14 +80,12 @@ private slots:
   void on_PBViewDesktopViewOnly_clicked();
   void on_PBViewDesktopFullControl_clicked();
   void on_RBUseLocalUser_toggled(bool checked);
+  void GotDeferredChecksFinished();
+  void GotSessionStartValidated(SessionStarter *argStarter);
+  void GotSettingsReloaded(int argAddedClients, int argRemovedClients);
+  void StartDeferredInitialization();
   void StartLocalzLeaf(const QString &argzLeafName,
                        const QString &argzLeafVersion, quint16 argzTreePort);
-  //! Updates the icons of the QTableView displaying the clients' states
-  /*!
-   * This function iterates over all valid items of the 'TVClients' and sets
-   * their states by querying the represented 'lcClient' instances.
-   */
-  void UpdateClientsTableView();
 
 signals:
   /*Session actions*/
@@ -111,36 +106,57 @@ private:
   //! Disables widgets for functions not available due to lacking devices or
   //! settings
   void DisableDisfunctionalWidgets();
+  //! Fills 'CBClientNames' with the names of all clients placed in the grid
+  void FillClientNames();
   //! Loads all needed client icon QPixmaps
   void LoadIconPixmaps();
+  //! Adds a tab showing the instrumentation's measurements if it is active
+  void SetupDiagnosticsTab();
+  //! Resumes the receipts jobs which did not finish in an earlier run
+  void ResumeReceiptsJobs();
+  //! Offers a tab per room if the lab consists of multiple ones
+  void SetupRoomsTabBar();
   //! Sets up all used widgets
   void SetupWidgets();
-
-  QStandardItemModel *clients_view_model =
-      nullptr; //! The view storing all clients data
-  QTimer *gui_update_timer =
-      nullptr; //! A QTimer triggering updates of the graphical user interface
+  //! Shows an information without blocking the event loop
+  void ShowInformation(const QString &argTitle, const QString &argText);
+  //! Starts z-Leaves on the clients, asking once about already running ones
+  void StartZLeaves(const QVector<Client *> &argClients,
+                    const QString &argCommand,
+                    const QString &argFakeName = QString{});
+
+  ClientSelection *clientSelection =
+      nullptr; //! Keeps track of the clients selected in 'LMVClients'
+  ClientsGridModel *clientsGridModel =
+      nullptr; //! The model representing the clients in the lab's grid
+  bool deferredChecksFinished =
+      false; //! Set once the deferred checks finished for the first time
   QVector<QPixmap> icons; //! Vector of pixmaps storing the icons indicating the
                           //! clients' statuses
   Lablib *lablib =
       nullptr; //! Accumulator of all program logic being accessed by the GUI
+  QTabBar *roomsTabBar =
+      nullptr; //! Switches between the rooms if the lab has multiple ones
   bool localzLeavesAreRunning =
       false; //! Stores if a local z-Leaf instance is running on the server
              //! ('true' if local z-Leaf exists)
+  QProgressBar *sessionStartProgress =
+      nullptr; //! Shows the progress of a running session start
   QButtonGroup *userChooseButtonGroup =
       nullptr; //! Used to group the radio buttons choosing which user shall be
                //! used for administrative client actions
   Ui::MainWindow *ui = nullptr; //! Pointer storing all GUI items
-  QVector<QStandardItem *> *valid_items =
-      nullptr; //! Stores all valid Client instances displayed by the table
-               //! view, its main use is as iterable object for
-               //! 'update_clients_table_view()'
 
 private slots:
   void StartReceiptsHandler(QString argzTreeDataTargetPath,
                             bool argReceiptsForLocalClients,
                             QString argAnonymousReceiptsPlaceholder,
                             QString argLatexHeaderName, QString argDateString);
+  void StartReceiptsBatch(const QString &argDirectory,
+                          bool argReceiptsForLocalClients,
+                          const QString &argAnonymousReceiptsPlaceholder,
+                          const QString &argTemplateName,
+                          ReceiptsBatch::Grouping argGrouping);
   void on_PBstartBrowser_clicked();
   void on_PBstopBrowser_clicked();
 
@@ -31,10 +31,7 @@ lc::ManualPrintingSetup::ManualPrintingSetup(QWidget *argParent)
     : QWidget{argParent}, ui{new Ui::ManualPrintingSetup} {
   ui->setupUi(this);
 
-  if (settings->dvipsCmd.isEmpty() || settings->latexCmd.isEmpty() ||
-      settings->lcDataDir.isEmpty() || settings->lprCmd.isEmpty() ||
-      settings->postscriptViewer.isEmpty() || settings->ps2pdfCmd.isEmpty() ||
-      settings->rmCmd.isEmpty() || settings->vncViewer.isEmpty()) {
+  if (!settings->AreReceiptsAvailable()) {
     ui->VLManualPrintingSetup->setEnabled(false);
     QMessageBox::information(
         this, tr("Receipts printing will not work"),
@@ -43,7 +40,8 @@ lc::ManualPrintingSetup::ManualPrintingSetup(QWidget *argParent)
            " printed."),
         QMessageBox::Ok);
   } else {
-    ui->CBReceiptsHeader->addItems(settings->installedLaTeXHeaders);
+    ui->CBReceiptsHeader->addItems(
+        settings->GetAvailableReceiptsTemplates());
 
     if (settings->defaultReceiptIndex &&
         settings->defaultReceiptIndex < ui->CBReceiptsHeader->count()) {
@@ -61,6 +59,8 @@ void lc::ManualPrintingSetup::on_PBSelectFile_clicked() {
   fileDialog.setOption(QFileDialog::ReadOnly, true);
   if (fileDialog.exec()) {
     ui->PBSelectFile->setStyleSheet("");
+    batchDirectory.clear();
+    ui->CBMergeBy->setEnabled(false);
     const QString tmpFileName{fileDialog.selectedFiles().at(0)};
     dateString =
         tmpFileName.split('/', QString::KeepEmptyParts, Qt::CaseInsensitive)
@@ -72,6 +72,16 @@ void lc::ManualPrintingSetup::on_PBSelectFile_clicked() {
   }
 }
 
+void lc::ManualPrintingSetup::on_PBSelectDirectory_clicked() {
+  const QString directory{QFileDialog::getExistingDirectory(
+      this, tr("Please choose a directory to reprint."), QDir::homePath())};
+  if (!directory.isEmpty()) {
+    ui->PBSelectFile->setStyleSheet("");
+    batchDirectory = directory;
+    ui->CBMergeBy->setEnabled(true);
+  }
+}
+
 void lc::ManualPrintingSetup::on_CBReceiptsHeader_activated(int argIndex) {
   Q_UNUSED(argIndex);
   ui->CBReceiptsHeader->setStyleSheet("");
@@ -91,6 +101,18 @@ void lc::ManualPrintingSetup::on_PBPrint_clicked() {
     anonymousReceiptsPlaceholder = ui->CBReplaceParticipantNames->currentText();
   }
 
+  if (!batchDirectory.isEmpty()) {
+    emit RequestReceiptsBatch(batchDirectory,
+                              ui->ChBReceiptsForLocalClients->isChecked(),
+                              anonymousReceiptsPlaceholder,
+                              ui->CBReceiptsHeader->currentText(),
+                              ui->CBMergeBy->currentIndex() == 0
+                                  ? ReceiptsBatch::Grouping::PER_DAY
+                                  : ReceiptsBatch::Grouping::PER_SESSION);
+    this->deleteLater();
+    return;
+  }
+
   emit RequestReceiptsHandler(workPath,
                               ui->ChBReceiptsForLocalClients->isChecked(),
                               anonymousReceiptsPlaceholder,
@@ -22,6 +22,8 @@
 
 #include <QWidget>
 
+#include "Lib/receiptsbatch.h"
+
 namespace lc {
 
 namespace Ui {
@@ -41,8 +43,15 @@ signals:
                               QString argAnonymousReceiptsPlaceholder,
                               QString argLatexHeaderName,
                               QString argDateString);
+  void RequestReceiptsBatch(const QString &argDirectory,
+                            bool argReceiptsForLocalClients,
+                            const QString &argAnonymousReceiptsPlaceholder,
+                            const QString &argTemplateName,
+                            ReceiptsBatch::Grouping argGrouping);
 
 private:
+  //! The directory chosen for a batch reprint (empty if a file was chosen)
+  QString batchDirectory;
   QString dateString;
   Ui::ManualPrintingSetup *ui = nullptr;
   QString workPath;
@@ -51,6 +60,7 @@ private slots:
   void on_CBReceiptsHeader_activated(int argIndex);
   void on_ChBPrintAnonymousReceipts_clicked(bool argChecked);
   void on_PBPrint_clicked();
+  void on_PBSelectDirectory_clicked();
   void on_PBSelectFile_clicked();
 };
 
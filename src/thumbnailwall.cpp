@@ -0,0 +1,150 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QPixmap>
+
+#include "thumbnailwall.h"
+
+namespace {
+//! The size the snapshots are shown in
+const QSize thumbnailSize{320, 240};
+} // namespace
+
+/*!
+ * \brief Construct a new wall showing the given clients' screens
+ *
+ * \param[in] argClients The clients whose screens shall be shown
+ * \param[in] argShowsAllClients True, if 'argClients' are all clients
+ * \param[in] argParent The instance's parent QWidget
+ */
+lc::ThumbnailWall::ThumbnailWall(const QVector<Client *> &argClients,
+                                 const bool argShowsAllClients,
+                                 QWidget *const argParent)
+    : QListWidget{argParent}, clients{argClients},
+      poller{new ThumbnailPoller{argClients, this}},
+      showsAllClients{argShowsAllClients} {
+  setViewMode(QListView::IconMode);
+  setIconSize(thumbnailSize);
+  setMovement(QListView::Static);
+  setResizeMode(QListView::Adjust);
+  setSelectionMode(QAbstractItemView::NoSelection);
+  setSpacing(4);
+  setUniformItemSizes(true);
+  setWindowTitle(tr("Thumbnail wall"));
+  CreateItems();
+
+  connect(poller, &ThumbnailPoller::FrameUpdated, this,
+          &ThumbnailWall::GotFrameUpdated);
+  connect(this, &QListWidget::itemActivated, this,
+          &ThumbnailWall::GotItemActivated);
+  ageTimer.setInterval(1000);
+  connect(&ageTimer, &QTimer::timeout, this, &ThumbnailWall::UpdateLabels);
+}
+
+/*!
+ * \brief Show the screens of the given clients from now on
+ *
+ * The snapshots of clients which are still shown are kept.
+ *
+ * \param[in] argClients The clients whose screens shall be shown
+ */
+void lc::ThumbnailWall::SetClients(const QVector<Client *> &argClients) {
+  clients = argClients;
+  poller->SetClients(argClients);
+  clear();
+  items.clear();
+  CreateItems();
+  UpdateLabels();
+}
+
+/*!
+ * \brief Stop polling while the wall is not visible
+ *
+ * \param[in] argEvent The hide event
+ */
+void lc::ThumbnailWall::hideEvent(QHideEvent *const argEvent) {
+  poller->Stop();
+  ageTimer.stop();
+  QListWidget::hideEvent(argEvent);
+}
+
+/*!
+ * \brief Start polling as soon as the wall becomes visible
+ *
+ * \param[in] argEvent The show event
+ */
+void lc::ThumbnailWall::showEvent(QShowEvent *const argEvent) {
+  QListWidget::showEvent(argEvent);
+  poller->Start();
+  ageTimer.start();
+  UpdateLabels();
+}
+
+/*!
+ * \brief Show the new snapshot of the given client
+ *
+ * \param[in] argClient The client whose snapshot was updated
+ */
+void lc::ThumbnailWall::GotFrameUpdated(lc::Client *const argClient) {
+  QListWidgetItem *const item = items.value(argClient);
+  if (!item) {
+    return;
+  }
+  item->setIcon(QIcon{QPixmap::fromImage(poller->GetFrame(argClient).image)});
+}
+
+/*!
+ * \brief Open a view-only VNC viewer for the activated thumbnail's client
+ *
+ * \param[in] argItem The activated item
+ */
+void lc::ThumbnailWall::GotItemActivated(QListWidgetItem *const argItem) {
+  clients.at(row(argItem))->ShowDesktopViewOnly();
+}
+
+/*!
+ * \brief Create a thumbnail for every client, showing its cached snapshot
+ */
+void lc::ThumbnailWall::CreateItems() {
+  QPixmap placeholder{thumbnailSize};
+  placeholder.fill(Qt::darkGray);
+  for (auto *const client : clients) {
+    const QImage image{poller->GetFrame(client).image};
+    // The items' rows correspond to the clients' indices
+    items.insert(client, new QListWidgetItem{
+                             image.isNull() ? QIcon{placeholder}
+                                            : QIcon{QPixmap::fromImage(image)},
+                             client->name, this});
+  }
+}
+
+/*!
+ * \brief Label all thumbnails with the ages of their snapshots
+ */
+void lc::ThumbnailWall::UpdateLabels() {
+  for (auto it = items.cbegin(); it != items.cend(); ++it) {
+    const qint64 age = poller->GetAge(poller->GetFrame(it.key()));
+    if (age < 0) {
+      it.value()->setText(it.key()->name);
+    } else {
+      it.value()->setText(
+          tr("%1 (%2 s ago)").arg(it.key()->name).arg(age / 1000));
+    }
+  }
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2014-2020 Markus Prasser
+ *
+ * This file is part of Labcontrol.
+ *
+ *  Labcontrol is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Labcontrol is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Labcontrol.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THUMBNAILWALL_H
+#define THUMBNAILWALL_H
+
+#include <QHash>
+#include <QListWidget>
+#include <QTimer>
+
+#include "Lib/thumbnailpoller.h"
+
+namespace lc {
+
+/*!
+ * \brief Shows the cached snapshots of many clients' screens in one window
+ *
+ * The snapshots are polled by a ThumbnailPoller while the wall is visible.
+ * Every thumbnail is labelled with its client's name and the age of the
+ * snapshot. Double clicking a thumbnail opens a view-only VNC viewer for its
+ * client.
+ */
+class ThumbnailWall : public QListWidget {
+  Q_OBJECT
+
+public:
+  explicit ThumbnailWall(const QVector<Client *> &argClients,
+                         bool argShowsAllClients, QWidget *argParent = nullptr);
+
+  const QVector<Client *> &GetClients() const { return clients; }
+  void SetClients(const QVector<Client *> &argClients);
+  //! Returns true, if the wall was opened for all clients, not a selection
+  bool ShowsAllClients() const { return showsAllClients; }
+
+protected:
+  void hideEvent(QHideEvent *argEvent) override;
+  void showEvent(QShowEvent *argEvent) override;
+
+private slots:
+  void GotFrameUpdated(lc::Client *argClient);
+  void GotItemActivated(QListWidgetItem *argItem);
+  void UpdateLabels();
+
+private:
+  void CreateItems();
+
+  //! Refreshes the shown ages of the snapshots
+  QTimer ageTimer;
+  //! The clients whose screens are shown
+  QVector<Client *> clients;
+  //! The item showing the thumbnail of every client
+  QHash<const Client *, QListWidgetItem *> items;
+  //! Fetches the snapshots of the clients' screens
+  ThumbnailPoller *const poller = nullptr;
+  //! Set if the wall shows all clients instead of a selection of them
+  const bool showsAllClients = false;
+};
+
+} // namespace lc
+
+#endif // THUMBNAILWALL_H